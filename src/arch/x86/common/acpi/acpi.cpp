@@ -0,0 +1,251 @@
+#include "x86/common/acpi/acpi.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <kernel/log.hpp>
+
+#include "boot/multiboot2.hpp"
+
+namespace x86::acpi {
+
+namespace {
+constexpr uintptr_t PageMask = 0xFFF;
+
+struct [[gnu::packed]] Rsdp {
+  char signature[8];
+  uint8_t checksum;
+  char oem_id[6];
+  uint8_t revision;
+  uint32_t rsdt_address;
+  // ACPI 2.0+
+  uint32_t length;
+  uint64_t xsdt_address;
+  uint8_t extended_checksum;
+  uint8_t reserved[3];
+};
+
+constexpr size_t RsdpV1Size = 20;
+
+struct [[gnu::packed]] Madt {
+  SdtHeader header;
+  uint32_t lapic_address;
+  uint32_t flags;
+};
+
+constexpr uint32_t MadtPcatCompat = 1u << 0;
+
+struct [[gnu::packed]] MadtEntry {
+  uint8_t type;
+  uint8_t length;
+};
+
+enum MadtType : uint8_t {
+  LocalApic = 0,
+  IoApic = 1,
+  SourceOverride = 2,
+  LocalApicAddressOverride = 5,
+};
+
+struct [[gnu::packed]] MadtLocalApic {
+  MadtEntry entry;
+  uint8_t processor_id;
+  uint8_t apic_id;
+  uint32_t flags;
+};
+
+constexpr uint32_t LapicEnabled = 1u << 0;
+
+struct [[gnu::packed]] MadtIoApic {
+  MadtEntry entry;
+  uint8_t id;
+  uint8_t reserved;
+  uint32_t address;
+  uint32_t gsi_base;
+};
+
+struct [[gnu::packed]] MadtSourceOverride {
+  MadtEntry entry;
+  uint8_t bus;
+  uint8_t source;
+  uint32_t gsi;
+  uint16_t flags;
+};
+
+struct [[gnu::packed]] MadtLapicOverride {
+  MadtEntry entry;
+  uint16_t reserved;
+  uint64_t address;
+};
+
+bool checksum_ok(const void* data, size_t len) noexcept {
+  const auto* p = static_cast<const uint8_t*>(data);
+  uint8_t sum = 0;
+  for (size_t i = 0; i < len; ++i) {
+    sum += p[i];
+  }
+  return sum == 0;
+}
+
+/// Firmware tables live in reserved memory, often above the early identity map.
+bool ensure_mapped(hal::Paging& paging, uintptr_t phys, size_t len) noexcept {
+  const uintptr_t end = (phys + len + PageMask) & ~PageMask;
+  for (uintptr_t page = phys & ~PageMask; page < end; page += PageMask + 1) {
+    uintptr_t out;
+    hal::PageFlags flags;
+    if (paging.translate(page, out, flags)) continue;
+    if (!paging.map(page, page, hal::PageFlags::None)) return false;
+    paging.flush(page);
+  }
+  return true;
+}
+
+const Rsdp* scan_for_rsdp(uintptr_t begin, uintptr_t end) noexcept {
+  for (uintptr_t p = begin; p + RsdpV1Size <= end; p += 16) {
+    const auto* rsdp = reinterpret_cast<const Rsdp*>(p);
+    if (memcmp(rsdp->signature, "RSD PTR ", 8) == 0 && checksum_ok(rsdp, RsdpV1Size)) {
+      return rsdp;
+    }
+  }
+  return nullptr;
+}
+
+const Rsdp* find_rsdp() noexcept {
+  // The loader hands over a copy of the RSDP, preferably the 2.0 one
+  constexpr mb2::TagType tag_types[] = {mb2::TagType::AcpiV2RsdPtr,
+                                         mb2::TagType::AcpiV1RsdPtr};
+  auto& tags = mb2::get_tag_map();
+  for (auto type : tag_types) {
+    if (auto* header = tags.find(type)) {
+      return reinterpret_cast<const Rsdp*>(reinterpret_cast<uintptr_t>(*header) +
+                                           mb2::HeaderSize);
+    }
+  }
+
+  // BIOS: first KiB of the EBDA (its segment is in the BDA), then the read only area.
+  // The empty asm hides the constant from gcc, which rejects pointers into page 0.
+  uintptr_t bda_ebda = 0x40E;
+  asm("" : "+r"(bda_ebda));
+  const uintptr_t ebda = uintptr_t{*reinterpret_cast<const uint16_t*>(bda_ebda)} << 4;
+  if (ebda) {
+    if (const Rsdp* rsdp = scan_for_rsdp(ebda, ebda + 1024)) return rsdp;
+  }
+  return scan_for_rsdp(0xE0000, 0x100000);
+}
+
+const SdtHeader* map_table(hal::Paging& paging, uintptr_t phys) noexcept {
+  if (!ensure_mapped(paging, phys, sizeof(SdtHeader))) return nullptr;
+
+  const auto* header = reinterpret_cast<const SdtHeader*>(phys);
+  if (!ensure_mapped(paging, phys, header->length)) return nullptr;
+  return checksum_ok(header, header->length) ? header : nullptr;
+}
+
+const SdtHeader* find_table(hal::Paging& paging, const Rsdp& rsdp,
+                            const char* signature) noexcept {
+  // i386 can only follow an XSDT that itself sits below 4 GiB
+  const bool use_xsdt = rsdp.revision >= 2 && rsdp.xsdt_address &&
+                        rsdp.xsdt_address < 0x1'0000'0000ull;
+  const uintptr_t root_phys = use_xsdt ? static_cast<uintptr_t>(rsdp.xsdt_address)
+                                       : uintptr_t{rsdp.rsdt_address};
+
+  const SdtHeader* root = map_table(paging, root_phys);
+  if (!root) return nullptr;
+
+  const size_t entry_size = use_xsdt ? 8 : 4;
+  const size_t count = (root->length - sizeof(SdtHeader)) / entry_size;
+  const auto* entries = reinterpret_cast<const uint8_t*>(root) + sizeof(SdtHeader);
+
+  for (size_t i = 0; i < count; ++i) {
+    uint64_t phys = 0;
+    memcpy(&phys, entries + i * entry_size, entry_size);
+    if (phys >= 0x1'0000'0000ull) continue;
+
+    const SdtHeader* table = map_table(paging, static_cast<uintptr_t>(phys));
+    if (table && memcmp(table->signature, signature, 4) == 0) return table;
+  }
+  return nullptr;
+}
+
+void parse_madt(const Madt& madt, MadtInfo& out) noexcept {
+  out.lapic_base = madt.lapic_address;
+  out.has_pic = madt.flags & MadtPcatCompat;
+
+  const auto* p = reinterpret_cast<const uint8_t*>(&madt) + sizeof(Madt);
+  const auto* end = reinterpret_cast<const uint8_t*>(&madt) + madt.header.length;
+
+  while (p + sizeof(MadtEntry) <= end) {
+    const auto* entry = reinterpret_cast<const MadtEntry*>(p);
+    if (entry->length < sizeof(MadtEntry) || p + entry->length > end) break;
+
+    switch (entry->type) {
+      case LocalApic: {
+        const auto* e = reinterpret_cast<const MadtLocalApic*>(p);
+        if (!(e->flags & LapicEnabled)) break;
+        if (out.cpu_count < hal::smp::MAX_CPUS) {
+          out.apic_ids[out.cpu_count++] = e->apic_id;
+        } else {
+          LOG_WARN(Boot, "acpi: ignoring cpu with APIC id %u, limit is %u", e->apic_id,
+                   hal::smp::MAX_CPUS);
+        }
+        break;
+      }
+      case IoApic: {
+        const auto* e = reinterpret_cast<const MadtIoApic*>(p);
+        if (out.has_ioapic) {
+          LOG_WARN(Boot, "acpi: ignoring IO APIC %u for GSIs from %u", e->id,
+                   e->gsi_base);
+          break;
+        }
+        out.has_ioapic = true;
+        out.ioapic_id = e->id;
+        out.ioapic_base = e->address;
+        out.ioapic_gsi_base = e->gsi_base;
+        break;
+      }
+      case SourceOverride: {
+        const auto* e = reinterpret_cast<const MadtSourceOverride*>(p);
+        if (e->bus == 0 && out.override_count < MaxIrqOverrides) {
+          out.overrides[out.override_count++] = {e->source, e->gsi, e->flags};
+        }
+        break;
+      }
+      case LocalApicAddressOverride: {
+        const auto* e = reinterpret_cast<const MadtLapicOverride*>(p);
+        if (e->address < 0x1'0000'0000ull) {
+          out.lapic_base = static_cast<uint32_t>(e->address);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    p += entry->length;
+  }
+}
+}  // namespace
+
+bool read_madt(hal::Paging& paging, MadtInfo& out) noexcept {
+  out = {};
+
+  const Rsdp* rsdp = find_rsdp();
+  if (!rsdp) {
+    LOG_INFO(Boot, "acpi: no RSDP found");
+    return false;
+  }
+
+  const SdtHeader* madt = find_table(paging, *rsdp, "APIC");
+  if (!madt) {
+    LOG_INFO(Boot, "acpi: no valid MADT");
+    return false;
+  }
+
+  parse_madt(*reinterpret_cast<const Madt*>(madt), out);
+  LOG_INFO(Boot, "acpi: %u cpus, LAPIC at %x, IO APIC %s, %u IRQ overrides",
+           out.cpu_count, out.lapic_base, out.has_ioapic ? "present" : "missing",
+           out.override_count);
+  return out.cpu_count > 0;
+}
+
+}  // namespace x86::acpi
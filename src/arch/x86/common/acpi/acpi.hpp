@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/paging.hpp"
+#include "hal/smp.hpp"
+
+namespace x86::acpi {
+
+struct [[gnu::packed]] SdtHeader {
+  char signature[4];
+  uint32_t length;
+  uint8_t revision;
+  uint8_t checksum;
+  char oem_id[6];
+  char oem_table_id[8];
+  uint32_t oem_revision;
+  uint32_t creator_id;
+  uint32_t creator_revision;
+};
+
+/// An ISA IRQ the firmware wired to another GSI, or with other than edge/active high.
+struct IrqOverride {
+  uint8_t irq;
+  uint32_t gsi;
+  uint16_t flags;  // MPS INTI flags: bits 0-1 polarity, 2-3 trigger mode
+};
+
+inline constexpr size_t MaxIrqOverrides = 16;
+
+/// What the MADT ("APIC" table) tells about the interrupt hardware. Only the first IO
+/// APIC is kept, enough for PCs and qemu.
+struct MadtInfo {
+  uint32_t lapic_base;
+  bool has_pic;  // Dual 8259 present, has to be masked before using the IO APIC
+
+  uint32_t cpu_count;
+  uint8_t apic_ids[hal::smp::MAX_CPUS];
+
+  bool has_ioapic;
+  uint8_t ioapic_id;
+  uint32_t ioapic_base;
+  uint32_t ioapic_gsi_base;
+
+  size_t override_count;
+  IrqOverride overrides[MaxIrqOverrides];
+};
+
+/// Find the RSDP (multiboot2 tag first, then the BIOS areas), walk the RSDT/XSDT and
+/// read the MADT. Tables outside the identity mapped range get mapped on the way.
+/// Returns false without ACPI, without a MADT or on bad checksums.
+bool read_madt(hal::Paging& paging, MadtInfo& out) noexcept;
+
+}  // namespace x86::acpi
@@ -4,8 +4,8 @@
 namespace board::pc {
 
 static constexpr SerialDesc serials[] = {
-    {"com1", 0x3F8, 4},
-    {"com2", 0x2F8, 3},
+    {"com1", 0x3F8, 4, 115200},
+    {"com2", 0x2F8, 3, 115200},
 };
 
 const SerialDesc* serial_begin() noexcept {
@@ -0,0 +1,181 @@
+#include "x86/common/cpu/features.hpp"
+
+#include <cstring>
+
+#include "hal/cpu_features.hpp"
+#include "hal/cycles.hpp"
+#include "math/scale.hpp"
+#include "x86/common/cpu/regs.hpp"
+
+using hal::cpu::Feature;
+
+namespace x86::cpu {
+
+namespace {
+hal::cpu::Features detected{};
+uint32_t tsc_khz{0};
+uint32_t xsave_size{0};
+math::Scale tsc_to_ns{};
+
+// CPUID bits we care about
+namespace leaf1_edx {
+constexpr uint32_t TSC = 1u << 4;
+constexpr uint32_t PSE = 1u << 3;
+constexpr uint32_t APIC = 1u << 9;
+constexpr uint32_t PGE = 1u << 13;
+constexpr uint32_t PAT = 1u << 16;
+constexpr uint32_t FXSR = 1u << 24;
+constexpr uint32_t SSE = 1u << 25;
+constexpr uint32_t SSE2 = 1u << 26;
+}  // namespace leaf1_edx
+
+namespace leaf1_ecx {
+constexpr uint32_t SSE42 = 1u << 20;
+constexpr uint32_t XSAVE = 1u << 26;
+constexpr uint32_t AVX = 1u << 28;
+}  // namespace leaf1_ecx
+
+namespace leaf7_ebx {
+constexpr uint32_t AVX2 = 1u << 5;
+constexpr uint32_t ERMS = 1u << 9;
+}  // namespace leaf7_ebx
+
+namespace leaf80000007_edx {
+constexpr uint32_t INVARIANT_TSC = 1u << 8;
+}
+
+bool has_cpuid() noexcept {
+  constexpr uint32_t IdFlag = 1u << 21;
+  uint32_t before, after;
+  asm volatile(
+      "pushf\n\t"
+      "pop %0\n\t"
+      "mov %0, %1\n\t"
+      "xor %2, %1\n\t"
+      "push %1\n\t"
+      "popf\n\t"
+      "pushf\n\t"
+      "pop %1\n\t"
+      "push %0\n\t"
+      "popf"
+      : "=&r"(before), "=&r"(after)
+      : "ri"(IdFlag)
+      : "cc");
+  return ((before ^ after) & IdFlag) != 0;
+}
+
+bool enable_sse() noexcept {
+  uint32_t c0 = read_cr0();
+  c0 &= ~(cr0::EM | cr0::TS);
+  c0 |= cr0::MP | cr0::NE;
+  write_cr0(c0);
+  asm volatile("fninit");
+
+  write_cr4(read_cr4() | cr4::OSFXSR | cr4::OSXMMEXCPT);
+  return true;
+}
+
+bool enable_avx() noexcept {
+  write_cr4(read_cr4() | cr4::OSXSAVE);
+  xsetbv(0, xgetbv(0) | xcr0::X87 | xcr0::SSE | xcr0::AVX);
+  return (xgetbv(0) & (xcr0::SSE | xcr0::AVX)) == (xcr0::SSE | xcr0::AVX);
+}
+
+}  // namespace
+
+void init_features() noexcept {
+  if (!has_cpuid()) {
+    memcpy(detected.vendor, "NoCPUID", 8);
+    return;
+  }
+
+  auto l0 = cpuid(0);
+  uint32_t max_leaf = l0.eax;
+  memcpy(detected.vendor + 0, &l0.ebx, 4);
+  memcpy(detected.vendor + 4, &l0.edx, 4);
+  memcpy(detected.vendor + 8, &l0.ecx, 4);
+  detected.vendor[12] = '\0';
+
+  if (max_leaf < 1) return;
+
+  auto l1 = cpuid(1);
+  uint32_t family = (l1.eax >> 8) & 0xF;
+  uint32_t model = (l1.eax >> 4) & 0xF;
+  if (family == 0xF) family += (l1.eax >> 20) & 0xFF;
+  if (family == 0x6 || family >= 0xF) model |= ((l1.eax >> 16) & 0xF) << 4;
+  detected.family = family;
+  detected.model = model;
+  detected.stepping = l1.eax & 0xF;
+
+  Feature f = Feature::None;
+  if (l1.edx & leaf1_edx::TSC) f |= Feature::Tsc;
+  if (l1.edx & leaf1_edx::PSE) f |= Feature::Pse;
+  if (l1.edx & leaf1_edx::PGE) f |= Feature::Pge;
+  if (l1.edx & leaf1_edx::PAT) f |= Feature::Pat;
+  if (l1.edx & leaf1_edx::APIC) f |= Feature::Apic;
+
+  uint32_t ext7_ebx = max_leaf >= 7 ? cpuid(7, 0).ebx : 0;
+  if (ext7_ebx & leaf7_ebx::ERMS) f |= Feature::Erms;
+
+  uint32_t max_ext = cpuid(0x80000000u).eax;
+  if (max_ext >= 0x80000007u &&
+      (cpuid(0x80000007u).edx & leaf80000007_edx::INVARIANT_TSC)) {
+    f |= Feature::InvariantTsc;
+  }
+
+  // SIMD state only counts as available once we have switched it on.
+  bool fxsr = (l1.edx & leaf1_edx::FXSR) && (l1.edx & leaf1_edx::SSE);
+  if (fxsr && enable_sse()) {
+    f |= Feature::Fxsr | Feature::Sse;
+    if (l1.edx & leaf1_edx::SSE2) f |= Feature::Sse2;
+    if (l1.ecx & leaf1_ecx::SSE42) f |= Feature::Sse42;
+
+    // Interrupts save AVX state with xsave, which needs leaf 0xD for the area size
+    const bool avx = max_leaf >= 0xD && (l1.ecx & leaf1_ecx::XSAVE) &&
+                     (l1.ecx & leaf1_ecx::AVX);
+    if (avx && enable_avx()) {
+      f |= Feature::Xsave | Feature::Avx;
+      if (ext7_ebx & leaf7_ebx::AVX2) f |= Feature::Avx2;
+      // ebx: size of the area for the components XCR0 has on right now
+      xsave_size = (cpuid(0xD, 0).ebx + 63) & ~63u;
+    }
+  }
+
+  detected.flags = f;
+}
+
+void init_features_ap() noexcept {
+  if (detected.has(Feature::Sse)) enable_sse();
+  if (detected.has(Feature::Avx)) enable_avx();
+}
+
+uint32_t xsave_area_size() noexcept {
+  return xsave_size;
+}
+
+}  // namespace x86::cpu
+
+namespace hal::cpu {
+
+const Features& features() noexcept {
+  return x86::cpu::detected;
+}
+
+uint64_t cycles() noexcept {
+  return x86::cpu::detected.has(Feature::Tsc) ? x86::cpu::rdtsc() : 0;
+}
+
+uint32_t cycles_khz() noexcept {
+  return x86::cpu::tsc_khz;
+}
+
+void set_cycles_khz(uint32_t khz) noexcept {
+  x86::cpu::tsc_khz = khz;
+  x86::cpu::tsc_to_ns = math::Scale::between(khz, 1'000'000);
+}
+
+uint64_t cycles_to_ns(uint64_t cycles) noexcept {
+  return x86::cpu::tsc_to_ns.apply(cycles);
+}
+
+}  // namespace hal::cpu
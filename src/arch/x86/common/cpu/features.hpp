@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/cpu_features.hpp"
+
+namespace x86::cpu {
+
+/// Probe CPUID and enable the FPU/SSE (and AVX if present) register state for kernel
+/// use. Has to run before anything that may execute SIMD instructions.
+void init_features() noexcept;
+
+/// Switch on the SIMD state `init_features` enabled on the boot cpu for the calling cpu.
+/// Control registers are per cpu, application processors start with everything off.
+void init_features_ap() noexcept;
+
+/// Bytes an `xsave` of every state component enabled in XCR0 needs, rounded up to the
+/// 64 byte alignment the instruction wants. 0 without AVX, `fxsave` covers the rest.
+uint32_t xsave_area_size() noexcept;
+
+}  // namespace x86::cpu
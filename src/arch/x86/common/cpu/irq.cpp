@@ -0,0 +1,33 @@
+#include "hal/interrupts.hpp"
+#include "x86/common/cpu/regs.hpp"
+
+namespace hal::irq {
+
+void enable() noexcept {
+  asm volatile("sti" ::: "memory");
+}
+
+void disable() noexcept {
+  asm volatile("cli" ::: "memory");
+}
+
+bool enabled() noexcept {
+  return x86::cpu::read_eflags() & x86::cpu::eflags::IF;
+}
+
+bool save_and_disable() noexcept {
+  const bool was_enabled = enabled();
+  disable();
+  return was_enabled;
+}
+
+void restore(bool was_enabled) noexcept {
+  if (was_enabled) enable();
+}
+
+void wait() noexcept {
+  // sti only takes effect after the next instruction, nothing can slip in before hlt
+  asm volatile("sti; hlt" ::: "memory");
+}
+
+}  // namespace hal::irq
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+namespace x86::cpu {
+
+struct CpuidResult {
+  uint32_t eax;
+  uint32_t ebx;
+  uint32_t ecx;
+  uint32_t edx;
+};
+
+inline CpuidResult cpuid(uint32_t leaf, uint32_t subleaf = 0) noexcept {
+  CpuidResult r;
+  asm volatile("cpuid"
+               : "=a"(r.eax), "=b"(r.ebx), "=c"(r.ecx), "=d"(r.edx)
+               : "a"(leaf), "c"(subleaf));
+  return r;
+}
+
+inline uint32_t read_eflags() noexcept {
+  uint32_t v;
+  asm volatile("pushf\n\tpop %0" : "=r"(v));
+  return v;
+}
+
+inline uint64_t rdtsc() noexcept {
+  uint32_t lo, hi;
+  asm volatile("rdtsc" : "=a"(lo), "=d"(hi));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline uint32_t read_cr0() noexcept {
+  uint32_t v;
+  asm volatile("mov %%cr0, %0" : "=r"(v));
+  return v;
+}
+
+inline void write_cr0(uint32_t v) noexcept {
+  asm volatile("mov %0, %%cr0" ::"r"(v) : "memory");
+}
+
+inline uint32_t read_cr4() noexcept {
+  uint32_t v;
+  asm volatile("mov %%cr4, %0" : "=r"(v));
+  return v;
+}
+
+inline void write_cr4(uint32_t v) noexcept {
+  asm volatile("mov %0, %%cr4" ::"r"(v) : "memory");
+}
+
+inline uint64_t xgetbv(uint32_t index) noexcept {
+  uint32_t lo, hi;
+  asm volatile("xgetbv" : "=a"(lo), "=d"(hi) : "c"(index));
+  return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+
+inline void xsetbv(uint32_t index, uint64_t value) noexcept {
+  asm volatile("xsetbv" ::"c"(index), "a"(static_cast<uint32_t>(value)),
+               "d"(static_cast<uint32_t>(value >> 32)));
+}
+
+namespace eflags {
+constexpr uint32_t IF = 1u << 9;
+}  // namespace eflags
+
+namespace cr0 {
+constexpr uint32_t MP = 1u << 1;
+constexpr uint32_t EM = 1u << 2;
+constexpr uint32_t TS = 1u << 3;
+constexpr uint32_t NE = 1u << 5;
+}  // namespace cr0
+
+namespace cr4 {
+constexpr uint32_t PSE = 1u << 4;
+constexpr uint32_t PGE = 1u << 7;
+constexpr uint32_t OSFXSR = 1u << 9;
+constexpr uint32_t OSXMMEXCPT = 1u << 10;
+constexpr uint32_t OSXSAVE = 1u << 18;
+}  // namespace cr4
+
+namespace xcr0 {
+constexpr uint64_t X87 = 1u << 0;
+constexpr uint64_t SSE = 1u << 1;
+constexpr uint64_t AVX = 1u << 2;
+}  // namespace xcr0
+
+}  // namespace x86::cpu
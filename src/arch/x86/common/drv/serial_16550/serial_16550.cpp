@@ -1,20 +1,45 @@
 #include "x86/common/drv/serial_16550/serial_16550.hpp"
 
+#include <atomic>
+
+#include "sync/spinlock.hpp"
+
 namespace x86::drv {
 
+namespace {
+using TxGuard = sync::LockGuard<sync::IrqSpinLock>;
+
+namespace lsr {
+constexpr uint8_t DataReady = 0x01;
+constexpr uint8_t ThrEmpty = 0x20;
+constexpr uint8_t TxEmpty = 0x40;  // FIFO and shift register both drained
+}  // namespace lsr
+
+namespace ier {
+constexpr uint8_t RxData = 0x01;
+constexpr uint8_t ThrEmpty = 0x02;
+}  // namespace ier
+
+namespace iir {
+constexpr uint8_t NonePending = 0x01;
+constexpr uint8_t IdMask = 0x0E;
+constexpr uint8_t ThrEmpty = 0x02;
+constexpr uint8_t RxData = 0x04;
+constexpr uint8_t LineStatus = 0x06;
+constexpr uint8_t RxTimeout = 0x0C;
+}  // namespace iir
+
+void irq_trampoline(void* ctx) {
+  static_cast<Serial16550Impl*>(ctx)->handle_irq();
+}
+}  // namespace
+
 void Serial16550Impl::init() noexcept {
   // Disable interrupts
   int_en.out(0x00);
+  int_mask = 0;
 
-  // Enable DLAB (set baud divisor)
-  line_ctrl.out(0x80);
-
-  // Set divisor for 38400 baud: divisor = 3
-  data.out(0x03);    // low byte
-  int_en.out(0x00);  // high byte
-
-  // 8 bits, no parity, one stop bit, clear DLAB
-  line_ctrl.out(0x03);
+  set_baud(desc->baud ? desc->baud : BaseBaud);
 
   // Enable FIFO, clear them, 14-byte threshold
   fifo_ctrl.out(0xC7);
@@ -25,41 +50,193 @@ void Serial16550Impl::init() noexcept {
   inited = true;
 }
 
-bool Serial16550Impl::write_byte(uint8_t b) noexcept {
+bool Serial16550Impl::set_baud(uint32_t baud) noexcept {
+  if (!baud || baud > BaseBaud) return false;
+
+  uint32_t divisor = (BaseBaud + baud / 2) / baud;
+  if (divisor > 0xFFFF) divisor = 0xFFFF;
+
+  // Enable DLAB (set baud divisor)
+  line_ctrl.out(0x80);
+  data.out(static_cast<uint8_t>(divisor));         // low byte
+  int_en.out(static_cast<uint8_t>(divisor >> 8));  // high byte
+
+  // 8 bits, no parity, one stop bit, clear DLAB
+  line_ctrl.out(0x03);
+  int_en.out(int_mask);
+  return true;
+}
+
+bool Serial16550Impl::attach_irq(hal::InterruptController& ic) noexcept {
   if (!inited) return false;
 
-  if (b == '\n') {
-    write_raw('\r');
-    write_raw('\n');
-  } else {
-    write_raw(b);
-  }
+  ic.register_irq({desc->irq}, &irq_trampoline, this);
+  ic.enable_irq({desc->irq});
+  irq_driven = true;
 
+  int_mask |= ier::RxData;
+  int_en.out(int_mask);
+
+  // Anything queued before now still goes out in order
+  TxGuard guard{tx_lock};
+  if (tx_head != tx_tail) set_tx_irq(true);
   return true;
 }
 
+bool Serial16550Impl::write_byte(uint8_t b) noexcept {
+  static constexpr uint8_t crlf[] = {'\r', '\n'};
+
+  if (b == '\n') return write(crlf, sizeof(crlf));
+  return write(&b, 1);
+}
+
 bool Serial16550Impl::read_byte(uint8_t& bout) noexcept {
   if (!inited) return false;
-  if ((line_status.in() & 0x01) == 0) return false;
+
+  if (irq_driven) {
+    const uint32_t tail = rx_tail.load(std::memory_order_relaxed);
+    if (tail == rx_head.load(std::memory_order_acquire)) return false;
+
+    bout = rx_ring[tail % RxRingSize];
+    rx_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  if ((line_status.in() & lsr::DataReady) == 0) return false;
 
   bout = data.in();
   return true;
 }
 
+bool Serial16550Impl::rx_pending() const noexcept {
+  if (!inited) return false;
+  if (irq_driven) return rx_tail.load() != rx_head.load(std::memory_order_acquire);
+  return line_status.in() & lsr::DataReady;
+}
+
 bool Serial16550Impl::write(const uint8_t* data, size_t len) noexcept {
   if (!data) return false;
   if (!inited) return false;
 
-  for (size_t i = 0; i < len; ++i) {
-    write_raw(data[i]);
+  if (!irq_driven) {
+    TxGuard guard{tx_lock};
+    burst(data, len);
+    return true;
+  }
+
+  return enqueue(data, len);
+}
+
+void Serial16550Impl::flush() noexcept {
+  if (!inited) return;
+  if (irq_driven) pump_blocking();
+
+  // THRE only says the FIFO took the bytes, the last of them are still on their way out
+  while ((line_status.in() & lsr::TxEmpty) == 0) {}
+}
+
+void Serial16550Impl::handle_irq() noexcept {
+  for (;;) {
+    const uint8_t id = fifo_ctrl.in();
+    if (id & iir::NonePending) return;
+
+    switch (id & iir::IdMask) {
+      case iir::ThrEmpty:
+        refill_fifo();
+        break;
+      case iir::RxData:
+      case iir::RxTimeout:
+        receive();
+        break;
+      case iir::LineStatus:
+        (void)line_status.in();
+        break;
+      default:
+        // Modem status interrupts are not enabled
+        return;
+    }
+  }
+}
+
+void Serial16550Impl::burst(const uint8_t* data, size_t len) const noexcept {
+  // Once THR is empty the whole 16 byte TX FIFO is free, so one status poll covers a
+  // full burst instead of one per byte
+  while (len) {
+    while ((line_status.in() & lsr::ThrEmpty) == 0) {}
+
+    const size_t n = len < FifoSize ? len : FifoSize;
+    for (size_t i = 0; i < n; ++i) {
+      this->data.out(data[i]);
+    }
+    data += n;
+    len -= n;
+  }
+}
+
+bool Serial16550Impl::enqueue(const uint8_t* data, size_t len) noexcept {
+  while (len) {
+    TxGuard guard{tx_lock};
+    const uint32_t space = TxRingSize - (tx_head - tx_tail);
+    if (!space) {
+      // Full, so the interrupt handler is either not keeping up or cannot run at all
+      send_chunk();
+      continue;
+    }
+
+    const uint32_t n = len < space ? static_cast<uint32_t>(len) : space;
+    for (uint32_t i = 0; i < n; ++i) {
+      tx_ring[(tx_head + i) % TxRingSize] = data[i];
+    }
+    tx_head += n;
+    data += n;
+    len -= n;
+
+    if (!(int_mask & ier::ThrEmpty)) set_tx_irq(true);
   }
 
   return true;
 }
 
-void Serial16550Impl::write_raw(uint8_t b) const noexcept {
-  while ((line_status.in() & 0x20) == 0) {}
-  data.out(b);
+void Serial16550Impl::send_chunk() noexcept {
+  while ((line_status.in() & lsr::ThrEmpty) == 0) {}
+  for (size_t i = 0; i < FifoSize && tx_tail != tx_head; ++i, ++tx_tail) {
+    data.out(tx_ring[tx_tail % TxRingSize]);
+  }
+}
+
+void Serial16550Impl::refill_fifo() noexcept {
+  TxGuard guard{tx_lock};
+  send_chunk();
+  if (tx_tail == tx_head) set_tx_irq(false);
+}
+
+void Serial16550Impl::receive() noexcept {
+  uint32_t head = rx_head.load(std::memory_order_relaxed);
+  while (line_status.in() & lsr::DataReady) {
+    const uint8_t b = data.in();
+    if (head - rx_tail.load(std::memory_order_acquire) == RxRingSize) {
+      ++rx_overruns;
+      continue;
+    }
+    rx_ring[head++ % RxRingSize] = b;
+  }
+  rx_head.store(head, std::memory_order_release);
+}
+
+void Serial16550Impl::pump_blocking() noexcept {
+  // One FIFO at a time, the handler and other writers get their turn in between
+  for (;;) {
+    TxGuard guard{tx_lock};
+    if (tx_tail == tx_head) return;
+    send_chunk();
+  }
+}
+
+void Serial16550Impl::set_tx_irq(bool on) noexcept {
+  // Turning THRE on while THR is already empty raises the interrupt right away
+  hal::irq::Guard guard;
+  int_mask = on ? (int_mask | ier::ThrEmpty) : (int_mask & ~ier::ThrEmpty);
+  int_en.out(int_mask);
 }
 
 }  // namespace x86::drv
@@ -1,20 +1,33 @@
 #pragma once
 
 #include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 
 #include "board/serial_desc.hpp"
 #include "drv/driver.hpp"
 #include "drv/serial/serial.hpp"
+#include "hal/interrupts.hpp"
+#include "sync/spinlock.hpp"
 #include "x86/common/io/ports.hpp"
 
 namespace x86::drv {
 
+/// Polls the line status until an interrupt controller is attached. From then on
+/// writes only queue into a software ring and the THRE interrupt refills the 16 byte
+/// TX FIFO from it. `flush` and a full ring fall back to pumping the FIFO directly,
+/// which also keeps panics working with interrupts off, and `flush` then waits for the
+/// transmitter to go empty so nothing is lost to a reset. Any thread, cpu or handler may
+/// write, the TX ring and the FIFO are shared under one interrupt-safe lock. Received
+/// bytes are moved into an RX ring by the interrupt and `read_byte` takes them from
+/// there.
 class Serial16550Impl final : public ::drv::serial::Port {
  public:
   Serial16550Impl& operator=(const Serial16550Impl&) = delete;
   Serial16550Impl& operator=(Serial16550Impl&&) = delete;
   Serial16550Impl(const Serial16550Impl&) = delete;
-  Serial16550Impl(Serial16550Impl&&) = default;
+  Serial16550Impl(Serial16550Impl&&) = delete;
 
   Serial16550Impl() = default;
 
@@ -27,23 +40,66 @@ class Serial16550Impl final : public ::drv::serial::Port {
         modem_ctrl(desc.io_base + 4),
         line_status(desc.io_base + 5) {}
 
+  /// Divisor 1 with the standard 1.8432 MHz UART clock.
+  static constexpr uint32_t BaseBaud = 115200;
+
   void init() noexcept override;
   bool write_byte(uint8_t b) noexcept override;
   bool read_byte(uint8_t& b) noexcept override;
   bool write(const uint8_t* data, size_t len) noexcept override;
 
-  void flush() noexcept override {}
+  /// Blocks until everything queued has left the FIFO.
+  void flush() noexcept override;
+
+  /// Rounded to the nearest divisor the UART clock allows.
+  bool set_baud(uint32_t baud) noexcept;
+
+  /// Switch to interrupt driven transmit and receive on the line from the descriptor.
+  bool attach_irq(hal::InterruptController& ic) noexcept override;
+  bool rx_irq_driven() const noexcept override { return irq_driven; }
+  bool rx_pending() const noexcept override;
+
+  void handle_irq() noexcept;
 
   const board::SerialDesc& get_desc() const noexcept { return *desc; }
 
+  /// Received bytes lost because the RX ring was full.
+  uint32_t rx_dropped() const noexcept { return rx_overruns; }
+
  private:
-  void write_raw(uint8_t b) const noexcept;
+  static constexpr size_t FifoSize = 16;
+  static constexpr uint32_t TxRingSize = 1024;
+  static constexpr uint32_t RxRingSize = 256;
+
+  void burst(const uint8_t* data, size_t len) const noexcept;
+  bool enqueue(const uint8_t* data, size_t len) noexcept;
+  void send_chunk() noexcept;
+  void refill_fifo() noexcept;
+  void receive() noexcept;
+  void pump_blocking() noexcept;
+  void set_tx_irq(bool on) noexcept;
+
   const board::SerialDesc* desc;
   bool inited{false};
+  bool irq_driven{false};
+
+  // Writers, the blocking pump and the THRE handler all take it. Once interrupt driven
+  // it is held for one FIFO's worth of output at most, interrupts stay off only briefly
+  sync::IrqSpinLock tx_lock;
+  uint8_t tx_ring[TxRingSize]{};
+  uint32_t tx_head{0};
+  uint32_t tx_tail{0};
+
+  uint8_t rx_ring[RxRingSize]{};
+  std::atomic<uint32_t> rx_head{0};
+  std::atomic<uint32_t> rx_tail{0};
+  uint32_t rx_overruns{0};
+
+  uint8_t int_mask{0};  // Shadow of the interrupt enable register
 
   io::Port8 data;
   io::Port8 int_en;
-  io::Port8 fifo_ctrl;
+  io::Port8 fifo_ctrl;  // Reads as the interrupt identification register
   io::Port8 line_ctrl;
   io::Port8 modem_ctrl;
   io::Port8 line_status;
@@ -1,11 +1,18 @@
 #include "x86/common/input/keyboard.hpp"
 
 #include "hal/keyboard.hpp"
+#include "sched/idle.hpp"
 
 using namespace hal;
 
 namespace x86::input {
 
+namespace {
+void irq_trampoline(void* ctx) {
+  static_cast<PS2Keyboard*>(ctx)->handle_irq();
+}
+}  // namespace
+
 bool PS2Keyboard::poll_raw(RawKeyEvent& rke) noexcept {
 
   uint8_t status = status_port.in();
@@ -44,12 +51,7 @@ bool PS2Keyboard::poll_raw(RawKeyEvent& rke) noexcept {
   return true;
 }
 
-bool PS2Keyboard::poll(hal::KeyEvent& ev) noexcept {
-  static hal::KeyMod mods = hal::KeyMod::None;
-
-  RawKeyEvent raw{};
-  if (!poll_raw(raw)) { return false; }
-
+hal::KeyEvent PS2Keyboard::decode(const RawKeyEvent& raw) noexcept {
   uint16_t combined = raw.extended ? static_cast<uint16_t>((0xE0u << 8) | raw.scan_code)
                                    : static_cast<uint16_t>(raw.scan_code);
 
@@ -76,12 +78,53 @@ bool PS2Keyboard::poll(hal::KeyEvent& ev) noexcept {
     }
   }
 
-  ev.key = key;
-  ev.type = type;
-  ev.mods = mods;
-  ev.scan_code = raw.scan_code;
-  ev.extended = raw.extended;
+  return hal::KeyEvent{key, type, mods, raw.scan_code, raw.extended};
+}
+
+bool PS2Keyboard::poll(hal::KeyEvent& ev) noexcept {
+  if (irq_driven) return ring.try_pop(ev);
+
+  RawKeyEvent raw{};
+  if (!poll_raw(raw)) { return false; }
 
+  ev = decode(raw);
   return true;
 }
+
+bool PS2Keyboard::pending() const noexcept {
+  return !ring.empty();
+}
+
+void PS2Keyboard::wait_event(hal::KeyEvent& ev) noexcept {
+  while (!poll(ev)) {
+    if (irq_driven) {
+      sched::idle_wait([this] { return pending(); });
+    } else {
+      sched::run_idle_hooks();
+    }
+  }
+}
+
+bool PS2Keyboard::attach_irq(hal::InterruptController& ic) noexcept {
+  ic.register_irq(Irq, &irq_trampoline, this);
+
+  // Scan codes already sitting in the controller would hold IRQ1 back forever
+  {
+    hal::irq::Guard guard;
+    irq_driven = true;
+    handle_irq();
+  }
+
+  ic.enable_irq(Irq);
+  return true;
+}
+
+void PS2Keyboard::handle_irq() noexcept {
+  RawKeyEvent raw{};
+  while (poll_raw(raw)) {
+    // Keep what was typed first when full, the reader is behind anyway
+    if (!ring.try_push(decode(raw))) ++overruns;
+  }
+}
+
 }  // namespace x86::input
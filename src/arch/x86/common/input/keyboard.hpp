@@ -1,7 +1,11 @@
 #pragma once
 
-#include "x86/common/io/ports.hpp"
+#include <cstdint>
+
+#include "containers/spsc_ring.hpp"
+#include "hal/interrupts.hpp"
 #include "hal/keyboard.hpp"
+#include "x86/common/io/ports.hpp"
 
 namespace x86::input {
 
@@ -16,6 +20,9 @@ struct RawKeyEvent {
   RawEventType type;
 };
 
+/// Polls the controller until an interrupt controller is attached. From then on the
+/// IRQ1 handler decodes scan codes into a single producer, single consumer ring of key
+/// events, so keys typed while a command runs are kept until the shell reads them.
 class PS2Keyboard : public hal::Keyboard {
  public:
   static PS2Keyboard& get_instance() {
@@ -28,15 +35,34 @@ class PS2Keyboard : public hal::Keyboard {
   PS2Keyboard(const PS2Keyboard&) = delete;
   void operator=(const PS2Keyboard&) = delete;
 
+  static constexpr hal::Interrupt Irq{1};
+
   bool poll(hal::KeyEvent& ev) noexcept override;
+  void wait_event(hal::KeyEvent& ev) noexcept override;
+  bool attach_irq(hal::InterruptController& ic) noexcept override;
+
+  void handle_irq() noexcept;
+
+  /// Events lost because the ring was full.
+  uint32_t dropped() const noexcept { return overruns; }
 
  private:
+  static constexpr uint32_t RingSize = 64;
+
   PS2Keyboard() = default;
 
   bool poll_raw(RawKeyEvent& ev) noexcept;  // override;
+  hal::KeyEvent decode(const RawKeyEvent& raw) noexcept;
+  bool pending() const noexcept;
+
   io::Port8 data_port{0x60};
   io::Port8 status_port{0x64};
   bool extended_prefix{false};
+  hal::KeyMod mods{hal::KeyMod::None};
+  bool irq_driven{false};
+
+  ctr::SpscRing<hal::KeyEvent, RingSize> ring;
+  uint32_t overruns{0};
 };
 
 }  // namespace x86::input
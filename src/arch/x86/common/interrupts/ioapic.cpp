@@ -0,0 +1,136 @@
+#include "x86/common/interrupts/ioapic.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace x86::interrupts {
+
+namespace {
+constexpr uint32_t RegSelect = 0x00 / 4;
+constexpr uint32_t RegWindow = 0x10 / 4;
+
+constexpr uint32_t RegVersion = 0x01;
+constexpr uint32_t RegRedirection = 0x10;
+
+constexpr uint32_t RedirActiveLow = 1u << 13;
+constexpr uint32_t RedirLevel = 1u << 15;
+constexpr uint32_t RedirMasked = 1u << 16;
+
+// MPS INTI flags of the MADT overrides, 0 means "what the bus does" (ISA: high, edge)
+constexpr uint16_t PolarityMask = 0x3;
+constexpr uint16_t PolarityLow = 0x3;
+constexpr uint16_t TriggerMask = 0xC;
+constexpr uint16_t TriggerLevel = 0xC;
+}  // namespace
+
+bool IoApic::init(const acpi::MadtInfo& info, hal::Paging& paging,
+                  uint8_t dest_apic_id) noexcept {
+  if (!info.has_ioapic) return false;
+
+  const uintptr_t phys = info.ioapic_base;
+  if (!paging.map(phys, phys,
+                  hal::PageFlags::Writable | hal::PageFlags::CacheDisable |
+                      hal::PageFlags::WriteThrough)) {
+    return false;
+  }
+  paging.flush(phys);
+
+  regs = reinterpret_cast<volatile uint32_t*>(phys);
+  madt = &info;
+  gsi_base = info.ioapic_gsi_base;
+  dest = dest_apic_id;
+
+  pins = ((read(RegVersion) >> 16) & 0xFF) + 1;
+  if (pins > IoApicMaxPins) pins = IoApicMaxPins;
+
+  for (uint32_t pin = 0; pin < pins; ++pin) {
+    lines[pin] = {this, nullptr, nullptr, 0};
+    write(RegRedirection + 2 * pin, RedirMasked | (IoApicBase + pin));
+    write(RegRedirection + 2 * pin + 1, uint32_t{dest} << 24);
+  }
+  return true;
+}
+
+void IoApic::register_irq(hal::Interrupt line, HandlerFn handler, void* ctx) noexcept {
+  uint32_t flags = 0;
+  const int32_t pin = pin_for(line.vector, flags);
+  if (pin < 0) return;
+
+  hal::irq::Guard guard;
+  lines[pin].fn = handler;
+  lines[pin].ctx = ctx;
+  write(RegRedirection + 2 * pin, RedirMasked | flags | (IoApicBase + pin));
+  write(RegRedirection + 2 * pin + 1, uint32_t{dest} << 24);
+  set_vector_handler(static_cast<uint8_t>(IoApicBase + pin), &IoApic::dispatch,
+                     &lines[pin]);
+}
+
+void IoApic::enable_irq(hal::Interrupt line) noexcept {
+  uint32_t flags = 0;
+  const int32_t pin = pin_for(line.vector, flags);
+  if (pin >= 0) set_masked(pin, false);
+}
+
+void IoApic::disable_irq(hal::Interrupt line) noexcept {
+  uint32_t flags = 0;
+  const int32_t pin = pin_for(line.vector, flags);
+  if (pin >= 0) set_masked(pin, true);
+}
+
+void IoApic::send_eoi(hal::Interrupt) noexcept {
+  lapic.eoi();
+}
+
+uint32_t IoApic::irq_count(uint8_t line) const noexcept {
+  uint32_t flags = 0;
+  const int32_t pin = pin_for(line, flags);
+  return pin >= 0 ? lines[pin].count : 0;
+}
+
+void IoApic::dispatch(void* ctx) {
+  auto& line = *static_cast<Line*>(ctx);
+
+  ++line.count;
+  line.ioapic->lapic.eoi();
+  if (line.fn) line.fn(line.ctx);
+}
+
+int32_t IoApic::pin_for(uint8_t line, uint32_t& flags) const noexcept {
+  uint32_t gsi = line;
+  uint16_t inti = 0;
+  if (line < LegacyIrqCount) {
+    for (size_t i = 0; i < madt->override_count; ++i) {
+      if (madt->overrides[i].irq == line) {
+        gsi = madt->overrides[i].gsi;
+        inti = madt->overrides[i].flags;
+        break;
+      }
+    }
+  }
+
+  flags = 0;
+  if ((inti & PolarityMask) == PolarityLow) flags |= RedirActiveLow;
+  if ((inti & TriggerMask) == TriggerLevel) flags |= RedirLevel;
+
+  if (gsi < gsi_base || gsi - gsi_base >= pins) return -1;
+  return static_cast<int32_t>(gsi - gsi_base);
+}
+
+void IoApic::set_masked(uint32_t pin, bool masked) noexcept {
+  hal::irq::Guard guard;
+  uint32_t low = read(RegRedirection + 2 * pin);
+  low = masked ? (low | RedirMasked) : (low & ~RedirMasked);
+  write(RegRedirection + 2 * pin, low);
+}
+
+uint32_t IoApic::read(uint32_t reg) const noexcept {
+  regs[RegSelect] = reg;
+  return regs[RegWindow];
+}
+
+void IoApic::write(uint32_t reg, uint32_t value) noexcept {
+  regs[RegSelect] = reg;
+  regs[RegWindow] = value;
+}
+
+}  // namespace x86::interrupts
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "hal/paging.hpp"
+#include "x86/common/acpi/acpi.hpp"
+#include "x86/common/interrupts/lapic.hpp"
+#include "x86/common/interrupts/vectors.hpp"
+
+namespace x86::interrupts {
+
+/// The IO APIC as the interrupt controller, delivering to the boot cpu. Lines are ISA
+/// IRQ numbers and go through the MADT overrides (on PCs the PIT sits on GSI 2), higher
+/// numbers are GSIs. Pin N raises vector IoApicBase + N. Like the PIC, the EOI goes out
+/// before the handler runs.
+class IoApic final : public hal::InterruptController {
+ public:
+  IoApic(const IoApic&) = delete;
+  IoApic(IoApic&&) = delete;
+  IoApic& operator=(const IoApic&) = delete;
+  IoApic& operator=(IoApic&&) = delete;
+
+  explicit IoApic(LocalApic& lapic) noexcept : lapic(lapic) {}
+
+  /// Map the registers and mask every pin. `dest_apic_id` receives all interrupts.
+  bool init(const acpi::MadtInfo& madt, hal::Paging& paging,
+            uint8_t dest_apic_id) noexcept;
+
+  void register_irq(hal::Interrupt line, HandlerFn handler, void* ctx) noexcept override;
+  void enable_irq(hal::Interrupt line) noexcept override;
+  void disable_irq(hal::Interrupt line) noexcept override;
+  void send_eoi(hal::Interrupt line) noexcept override;
+
+  uint32_t irq_count(uint8_t line) const noexcept;
+  uint32_t pin_count() const noexcept { return pins; }
+
+ private:
+  struct Line {
+    IoApic* ioapic;
+    HandlerFn fn;
+    void* ctx;
+    uint32_t count;
+  };
+
+  static void dispatch(void* ctx);
+
+  /// Pin for `line` and the redirection flags (polarity, trigger) it needs, -1 if the
+  /// line is not on this IO APIC.
+  int32_t pin_for(uint8_t line, uint32_t& flags) const noexcept;
+  void set_masked(uint32_t pin, bool masked) noexcept;
+
+  uint32_t read(uint32_t reg) const noexcept;
+  void write(uint32_t reg, uint32_t value) noexcept;
+
+  LocalApic& lapic;
+  volatile uint32_t* regs{nullptr};
+  uint32_t gsi_base{0};
+  uint32_t pins{0};
+  uint8_t dest{0};
+
+  const acpi::MadtInfo* madt{nullptr};
+  Line lines[IoApicMaxPins]{};
+};
+
+}  // namespace x86::interrupts
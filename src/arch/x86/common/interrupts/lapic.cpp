@@ -0,0 +1,97 @@
+#include "x86/common/interrupts/lapic.hpp"
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "x86/common/interrupts/vectors.hpp"
+
+namespace x86::interrupts {
+
+namespace {
+constexpr uint32_t RegId = 0x020;
+constexpr uint32_t RegTpr = 0x080;
+constexpr uint32_t RegEoi = 0x0B0;
+constexpr uint32_t RegSvr = 0x0F0;
+constexpr uint32_t RegEsr = 0x280;
+constexpr uint32_t RegIcrLow = 0x300;
+constexpr uint32_t RegIcrHigh = 0x310;
+constexpr uint32_t RegLvtTimer = 0x320;
+
+constexpr uint32_t SvrEnable = 1u << 8;
+constexpr uint32_t LvtMasked = 1u << 16;
+
+constexpr uint32_t IcrFixed = 0u << 8;
+constexpr uint32_t IcrInit = 5u << 8;
+constexpr uint32_t IcrStartup = 6u << 8;
+constexpr uint32_t IcrAssert = 1u << 14;
+constexpr uint32_t IcrPending = 1u << 12;
+
+// Not acknowledged, the APIC drops it on its own
+void spurious(void*) {}
+}  // namespace
+
+bool LocalApic::map(hal::Paging& paging, uintptr_t phys) noexcept {
+  if (!paging.map(phys, phys,
+                  hal::PageFlags::Writable | hal::PageFlags::CacheDisable |
+                      hal::PageFlags::WriteThrough)) {
+    return false;
+  }
+  paging.flush(phys);
+
+  regs = reinterpret_cast<volatile uint32_t*>(phys);
+  set_vector_handler(ApicSpuriousVector, &spurious, nullptr);
+  return true;
+}
+
+void LocalApic::enable() noexcept {
+  write(RegTpr, 0);
+  write(RegLvtTimer, LvtMasked);
+  write(RegSvr, SvrEnable | ApicSpuriousVector);
+
+  // Errors latched before the enable are stale, the register wants a write before a read
+  write(RegEsr, 0);
+  (void)read(RegEsr);
+}
+
+uint8_t LocalApic::id() const noexcept {
+  return static_cast<uint8_t>(read(RegId) >> 24);
+}
+
+void LocalApic::eoi() noexcept {
+  write(RegEoi, 0);
+}
+
+void LocalApic::send_ipi(uint8_t apic_id, uint8_t vector) noexcept {
+  send_icr(apic_id, IcrFixed | IcrAssert | vector);
+}
+
+void LocalApic::send_init(uint8_t apic_id) noexcept {
+  send_icr(apic_id, IcrInit | IcrAssert);
+}
+
+void LocalApic::send_startup(uint8_t apic_id, uint8_t page) noexcept {
+  send_icr(apic_id, IcrStartup | IcrAssert | page);
+}
+
+uint32_t LocalApic::read(uint32_t reg) const noexcept {
+  return regs[reg / 4];
+}
+
+void LocalApic::write(uint32_t reg, uint32_t value) noexcept {
+  regs[reg / 4] = value;
+}
+
+void LocalApic::send_icr(uint8_t apic_id, uint32_t command) noexcept {
+  // The ICR is two registers, an interrupt in between could send its own IPI
+  hal::irq::Guard guard;
+  while (read(RegIcrLow) & IcrPending) {
+    asm volatile("pause");
+  }
+  write(RegIcrHigh, uint32_t{apic_id} << 24);
+  write(RegIcrLow, command);
+  while (read(RegIcrLow) & IcrPending) {
+    asm volatile("pause");
+  }
+}
+
+}  // namespace x86::interrupts
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/paging.hpp"
+
+namespace x86::interrupts {
+
+/// The local APIC through its register page. Every cpu sees its own APIC at the same
+/// address, so one object serves all of them and each call talks to the caller's APIC.
+class LocalApic {
+ public:
+  LocalApic(const LocalApic&) = delete;
+  LocalApic(LocalApic&&) = delete;
+  LocalApic& operator=(const LocalApic&) = delete;
+  LocalApic& operator=(LocalApic&&) = delete;
+
+  LocalApic() = default;
+
+  /// Map the register page uncached and route the spurious vector. Boot cpu, once.
+  bool map(hal::Paging& paging, uintptr_t phys) noexcept;
+  bool mapped() const noexcept { return regs != nullptr; }
+
+  /// Software enable the calling cpu's APIC, accept every priority, mask its timer. The
+  /// LINT pins keep what the firmware set up, so virtual wire mode still works.
+  void enable() noexcept;
+
+  uint8_t id() const noexcept;
+  void eoi() noexcept;
+
+  void send_ipi(uint8_t apic_id, uint8_t vector) noexcept;
+  void send_init(uint8_t apic_id) noexcept;
+  /// Startup IPI, the target starts in real mode at `page` * 4 KiB.
+  void send_startup(uint8_t apic_id, uint8_t page) noexcept;
+
+ private:
+  uint32_t read(uint32_t reg) const noexcept;
+  void write(uint32_t reg, uint32_t value) noexcept;
+  void send_icr(uint8_t apic_id, uint32_t command) noexcept;
+
+  volatile uint32_t* regs{nullptr};
+};
+
+}  // namespace x86::interrupts
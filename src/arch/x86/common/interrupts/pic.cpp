@@ -0,0 +1,113 @@
+#include "x86/common/interrupts/pic.hpp"
+
+#include <cstdint>
+
+namespace x86::interrupts {
+
+namespace {
+constexpr uint8_t Icw1Init = 0x11;  // Edge triggered, cascade, ICW4 follows
+constexpr uint8_t Icw4_8086 = 0x01;
+constexpr uint8_t Eoi = 0x20;
+constexpr uint8_t ReadIsr = 0x0B;
+constexpr uint8_t CascadeIrq = 2;
+
+// Any write to port 0x80 takes long enough for old PICs to settle between ICWs
+void io_wait() noexcept {
+  io::Port8{0x80}.out(0);
+}
+}  // namespace
+
+void Pic8259::init() noexcept {
+  master_cmd.out(Icw1Init);
+  io_wait();
+  slave_cmd.out(Icw1Init);
+  io_wait();
+
+  master_data.out(IrqBase);
+  io_wait();
+  slave_data.out(IrqBase + 8);
+  io_wait();
+
+  master_data.out(1u << CascadeIrq);
+  io_wait();
+  slave_data.out(CascadeIrq);
+  io_wait();
+
+  master_data.out(Icw4_8086);
+  io_wait();
+  slave_data.out(Icw4_8086);
+  io_wait();
+
+  // Spurious IRQ7/IRQ15 arrive even while masked, so those are always routed
+  for (uint8_t irq = 0; irq < LegacyIrqCount; ++irq) {
+    lines[irq] = {this, irq, nullptr, nullptr, 0};
+    set_vector_handler(IrqBase + irq, &Pic8259::dispatch, &lines[irq]);
+  }
+
+  mask = static_cast<uint16_t>(~(1u << CascadeIrq));
+  write_masks();
+}
+
+void Pic8259::register_irq(hal::Interrupt line, HandlerFn handler, void* ctx) noexcept {
+  if (line.vector >= LegacyIrqCount) return;
+
+  hal::irq::Guard guard;
+  lines[line.vector].fn = handler;
+  lines[line.vector].ctx = ctx;
+}
+
+void Pic8259::enable_irq(hal::Interrupt line) noexcept {
+  if (line.vector >= LegacyIrqCount) return;
+
+  hal::irq::Guard guard;
+  mask &= ~(1u << line.vector);
+  write_masks();
+}
+
+void Pic8259::disable_irq(hal::Interrupt line) noexcept {
+  if (line.vector >= LegacyIrqCount || line.vector == CascadeIrq) return;
+
+  hal::irq::Guard guard;
+  mask |= 1u << line.vector;
+  write_masks();
+}
+
+void Pic8259::send_eoi(hal::Interrupt line) noexcept {
+  if (line.vector >= 8) slave_cmd.out(Eoi);
+  master_cmd.out(Eoi);
+}
+
+void Pic8259::mask_all() noexcept {
+  hal::irq::Guard guard;
+  mask = 0xFFFF;
+  write_masks();
+}
+
+void Pic8259::dispatch(void* ctx) {
+  auto& line = *static_cast<Line*>(ctx);
+  Pic8259& pic = *line.pic;
+
+  if ((line.irq == 7 || line.irq == 15) && pic.is_spurious(line.irq)) {
+    ++pic.spurious;
+    // The master did raise a real IRQ2 for a spurious IRQ15 and wants its EOI
+    if (line.irq == 15) pic.master_cmd.out(Eoi);
+    return;
+  }
+
+  ++line.count;
+  pic.send_eoi({line.irq});
+  if (line.fn) line.fn(line.ctx);
+}
+
+bool Pic8259::is_spurious(uint8_t irq) noexcept {
+  const io::Port8& cmd = irq < 8 ? master_cmd : slave_cmd;
+  cmd.out(ReadIsr);
+  return (cmd.in() & (1u << (irq & 7))) == 0;
+}
+
+void Pic8259::write_masks() noexcept {
+  master_data.out(static_cast<uint8_t>(mask));
+  slave_data.out(static_cast<uint8_t>(mask >> 8));
+}
+
+}  // namespace x86::interrupts
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "x86/common/interrupts/vectors.hpp"
+#include "x86/common/io/ports.hpp"
+
+namespace x86::interrupts {
+
+/// The two cascaded 8259s of the PC, remapped to IrqBase. All lines start masked and
+/// are unmasked by `enable_irq`. The EOI goes out before the handler runs, so a
+/// handler that switches away does not block its line.
+class Pic8259 final : public hal::InterruptController {
+ public:
+  Pic8259(const Pic8259&) = delete;
+  Pic8259(Pic8259&&) = delete;
+  Pic8259& operator=(const Pic8259&) = delete;
+  Pic8259& operator=(Pic8259&&) = delete;
+
+  Pic8259() = default;
+
+  void init() noexcept;
+
+  void register_irq(hal::Interrupt line, HandlerFn handler, void* ctx) noexcept override;
+  void enable_irq(hal::Interrupt line) noexcept override;
+  void disable_irq(hal::Interrupt line) noexcept override;
+  void send_eoi(hal::Interrupt line) noexcept override;
+
+  /// IRQ7/IRQ15 raised without a line actually asking for service.
+  uint32_t spurious_count() const noexcept { return spurious; }
+
+  uint32_t irq_count(uint8_t line) const noexcept {
+    return line < LegacyIrqCount ? lines[line].count : 0;
+  }
+
+  /// Mask everything, e.g. once the IO APIC takes over.
+  void mask_all() noexcept;
+
+ private:
+  struct Line {
+    Pic8259* pic;
+    uint8_t irq;
+    HandlerFn fn;
+    void* ctx;
+    uint32_t count;
+  };
+
+  static void dispatch(void* ctx);
+  bool is_spurious(uint8_t irq) noexcept;
+  void write_masks() noexcept;
+
+  io::Port8 master_cmd{0x20};
+  io::Port8 master_data{0x21};
+  io::Port8 slave_cmd{0xA0};
+  io::Port8 slave_data{0xA1};
+
+  Line lines[LegacyIrqCount]{};
+  uint16_t mask{0xFFFF};
+  uint32_t spurious{0};
+};
+
+}  // namespace x86::interrupts
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+
+namespace x86::interrupts {
+
+/// Cpu vectors 0..31 are exceptions, the legacy IRQs are remapped right above them.
+inline constexpr uint8_t IrqBase = 0x20;
+inline constexpr uint8_t LegacyIrqCount = 16;
+
+/// IO APIC inputs sit above the PIC range, so stray PIC vectors never alias a GSI.
+inline constexpr uint8_t IoApicBase = 0x30;
+inline constexpr uint8_t IoApicMaxPins = 24;
+
+/// Local APIC vectors at the top, the highest priority class.
+inline constexpr uint8_t IpiCallVector = 0xF0;
+inline constexpr uint8_t ApicSpuriousVector = 0xFF;
+
+/// Route cpu vector `vector` to `handler`, provided by the variant's IDT code. The
+/// handler runs with interrupts off.
+bool set_vector_handler(uint8_t vector, hal::InterruptController::HandlerFn handler,
+                        void* ctx) noexcept;
+
+}  // namespace x86::interrupts
@@ -0,0 +1,253 @@
+#include "x86/common/simd/mem_ops.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+#include <kernel/mem_ops.hpp>
+
+#include "hal/cpu_features.hpp"
+
+// The kernel is not built with SSE enabled, every kernel opts in on its own. Loops in
+// here must also never be turned back into memcpy/memset calls.
+#define SIMD_KERNEL(isa) \
+  __attribute__((target(isa), optimize("no-tree-loop-distribute-patterns")))
+
+namespace x86::simd {
+
+namespace {
+
+SIMD_KERNEL("sse2") void* memcpy_sse2(void* __restrict__ dest,
+                                      const void* __restrict__ src, size_t count) {
+  auto* d = static_cast<uint8_t*>(dest);
+  auto* s = static_cast<const uint8_t*>(src);
+
+  for (; count >= 64; count -= 64, d += 64, s += 64) {
+    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 0));
+    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 16));
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 32));
+    __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + 48));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 0), a);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), b);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), c);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 48), e);
+  }
+
+  for (; count >= 16; count -= 16, d += 16, s += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d),
+                     _mm_loadu_si128(reinterpret_cast<const __m128i*>(s)));
+  }
+
+  for (; count; --count) {
+    *d++ = *s++;
+  }
+
+  return dest;
+}
+
+SIMD_KERNEL("sse2") void* memset_sse2(void* dest, int ch, size_t count) {
+  auto* d = static_cast<uint8_t*>(dest);
+  __m128i v = _mm_set1_epi8(static_cast<char>(ch));
+
+  for (; count >= 64; count -= 64, d += 64) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 0), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 16), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 32), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + 48), v);
+  }
+
+  for (; count >= 16; count -= 16, d += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d), v);
+  }
+
+  for (; count; --count) {
+    *d++ = static_cast<uint8_t>(ch);
+  }
+
+  return dest;
+}
+
+SIMD_KERNEL("sse2") void fill32_sse2(uint32_t* dest, uint32_t val, size_t count) {
+  __m128i v = _mm_set1_epi32(static_cast<int>(val));
+
+  for (; count >= 16; count -= 16, dest += 16) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 0), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 4), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 8), v);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest + 12), v);
+  }
+
+  for (; count >= 4; count -= 4, dest += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), v);
+  }
+
+  for (; count; --count) {
+    *dest++ = val;
+  }
+}
+
+SIMD_KERNEL("sse2") size_t strlen_sse2(const char* str) {
+  // Aligned 16 byte loads never cross a page, so starting at the block that holds str
+  // and masking off the bytes in front of it is safe.
+  const __m128i zero = _mm_setzero_si128();
+  const uintptr_t addr = reinterpret_cast<uintptr_t>(str);
+  auto* block = reinterpret_cast<const __m128i*>(addr & ~uintptr_t{15});
+
+  uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero));
+  mask >>= addr & 15;
+  if (mask) return __builtin_ctz(mask);
+
+  for (;;) {
+    ++block;
+    mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_load_si128(block), zero));
+    if (mask) {
+      return static_cast<size_t>(reinterpret_cast<const char*>(block) - str) +
+             __builtin_ctz(mask);
+    }
+  }
+}
+
+SIMD_KERNEL("sse2") void* memchr_sse2(const void* ptr, int ch, size_t count) {
+  auto* p = static_cast<const uint8_t*>(ptr);
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(ch));
+
+  for (; count >= 16; count -= 16, p += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+    uint32_t mask = _mm_movemask_epi8(_mm_cmpeq_epi8(v, needle));
+    if (mask) return const_cast<uint8_t*>(p + __builtin_ctz(mask));
+  }
+
+  for (; count; --count, ++p) {
+    if (*p == static_cast<uint8_t>(ch)) return const_cast<uint8_t*>(p);
+  }
+
+  return nullptr;
+}
+
+SIMD_KERNEL("avx") void* memcpy_avx(void* __restrict__ dest, const void* __restrict__ src,
+                                    size_t count) {
+  auto* d = static_cast<uint8_t*>(dest);
+  auto* s = static_cast<const uint8_t*>(src);
+
+  for (; count >= 128; count -= 128, d += 128, s += 128) {
+    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 0));
+    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 32));
+    __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 64));
+    __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + 96));
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 0), a);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 32), b);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 64), c);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 96), e);
+  }
+
+  for (; count >= 32; count -= 32, d += 32, s += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d),
+                        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s)));
+  }
+
+  for (; count; --count) {
+    *d++ = *s++;
+  }
+
+  return dest;
+}
+
+SIMD_KERNEL("avx") void* memset_avx(void* dest, int ch, size_t count) {
+  auto* d = static_cast<uint8_t*>(dest);
+  __m256i v = _mm256_set1_epi8(static_cast<char>(ch));
+
+  for (; count >= 128; count -= 128, d += 128) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 0), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 32), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 64), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d + 96), v);
+  }
+
+  for (; count >= 32; count -= 32, d += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(d), v);
+  }
+
+  for (; count; --count) {
+    *d++ = static_cast<uint8_t>(ch);
+  }
+
+  return dest;
+}
+
+SIMD_KERNEL("avx") void fill32_avx(uint32_t* dest, uint32_t val, size_t count) {
+  __m256i v = _mm256_set1_epi32(static_cast<int>(val));
+
+  for (; count >= 32; count -= 32, dest += 32) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 0), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 8), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 16), v);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest + 24), v);
+  }
+
+  for (; count >= 8; count -= 8, dest += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dest), v);
+  }
+
+  for (; count; --count) {
+    *dest++ = val;
+  }
+}
+
+void* memcpy_erms(void* __restrict__ dest, const void* __restrict__ src, size_t count) {
+  void* d = dest;
+  asm volatile("rep movsb" : "+D"(d), "+S"(src), "+c"(count) : : "memory");
+  return dest;
+}
+
+void* memset_erms(void* dest, int ch, size_t count) {
+  void* d = dest;
+  asm volatile("rep stosb" : "+D"(d), "+c"(count) : "a"(ch) : "memory");
+  return dest;
+}
+
+void fill32_erms(uint32_t* dest, uint32_t val, size_t count) {
+  asm volatile("rep stosl" : "+D"(dest), "+c"(count) : "a"(val) : "memory");
+}
+
+constexpr klibc::MemOps avx_ops{
+    .name = "avx",
+    .memcpy = &memcpy_avx,
+    .memset = &memset_avx,
+    .fill32 = &fill32_avx,
+    .strlen = &strlen_sse2,
+    .memchr = &memchr_sse2,
+};
+
+constexpr klibc::MemOps sse2_ops{
+    .name = "sse2",
+    .memcpy = &memcpy_sse2,
+    .memset = &memset_sse2,
+    .fill32 = &fill32_sse2,
+    .strlen = &strlen_sse2,
+    .memchr = &memchr_sse2,
+};
+
+constexpr klibc::MemOps erms_ops{
+    .name = "erms",
+    .memcpy = &memcpy_erms,
+    .memset = &memset_erms,
+    .fill32 = &fill32_erms,
+    .strlen = nullptr,
+    .memchr = nullptr,
+};
+
+}  // namespace
+
+void install_mem_ops(const hal::cpu::Features& features) noexcept {
+  using hal::cpu::Feature;
+
+  if (features.has(Feature::Avx)) {
+    klibc::set_mem_ops(avx_ops);
+  } else if (features.has(Feature::Sse2)) {
+    klibc::set_mem_ops(sse2_ops);
+  } else if (features.has(Feature::Erms)) {
+    klibc::set_mem_ops(erms_ops);
+  }
+}
+
+}  // namespace x86::simd
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "hal/cpu_features.hpp"
+
+namespace x86::simd {
+
+/// Point klibc's memory and string routines at the widest variant the cpu supports.
+void install_mem_ops(const hal::cpu::Features& features) noexcept;
+
+}  // namespace x86::simd
@@ -0,0 +1,96 @@
+#include <atomic>
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "hal/smp.hpp"
+#include "x86/common/interrupts/vectors.hpp"
+#include "x86/common/smp/percpu.hpp"
+
+namespace x86::smp {
+
+PerCpu cpus[hal::smp::MAX_CPUS]{};
+
+namespace {
+interrupts::LocalApic* apic{nullptr};
+std::atomic<uint32_t> online_count{1};
+
+void on_call_ipi(void*) {
+  PerCpu& self = this_cpu();
+  ++self.ipis;
+
+  const hal::smp::CallFn fn = self.call_fn;
+  void* arg = self.call_arg;
+  const uint32_t seq = self.sent.load(std::memory_order_acquire);
+  self.busy.clear(std::memory_order_release);
+  apic->eoi();
+
+  fn(arg);
+  self.done.store(seq, std::memory_order_release);
+}
+}  // namespace
+
+void init_ipi(interrupts::LocalApic& lapic) noexcept {
+  apic = &lapic;
+  cpus[0].apic_id = lapic.id();
+  cpus[0].online.store(true, std::memory_order_release);
+  interrupts::set_vector_handler(interrupts::IpiCallVector, &on_call_ipi, nullptr);
+}
+
+void mark_online(uint32_t cpu) noexcept {
+  cpus[cpu].online.store(true, std::memory_order_release);
+  online_count.fetch_add(1, std::memory_order_acq_rel);
+}
+
+}  // namespace x86::smp
+
+namespace hal::smp {
+
+using x86::smp::cpus;
+
+uint32_t cpu_id() noexcept {
+  return x86::smp::this_cpu().id;
+}
+
+uint32_t cpu_count() noexcept {
+  return x86::smp::online_count.load(std::memory_order_acquire);
+}
+
+bool call_on(uint32_t cpu, CallFn fn, void* arg, bool wait) noexcept {
+  if (cpu >= MAX_CPUS || !fn) return false;
+
+  if (cpu == cpu_id()) {
+    irq::Guard guard;
+    fn(arg);
+    return true;
+  }
+
+  auto& target = cpus[cpu];
+  if (!target.online.load(std::memory_order_acquire)) return false;
+
+  while (target.busy.test_and_set(std::memory_order_acquire)) {
+    asm volatile("pause");
+  }
+  target.call_fn = fn;
+  target.call_arg = arg;
+  const uint32_t seq = target.sent.load(std::memory_order_relaxed) + 1;
+  target.sent.store(seq, std::memory_order_release);
+
+  x86::smp::apic->send_ipi(target.apic_id, x86::interrupts::IpiCallVector);
+
+  if (wait) {
+    // Wrapping compare, later calls by others may already have finished too
+    while (static_cast<int32_t>(target.done.load(std::memory_order_acquire) - seq) < 0) {
+      asm volatile("pause");
+    }
+  }
+  return true;
+}
+
+void call_on_others(CallFn fn, void* arg, bool wait) noexcept {
+  const uint32_t self = cpu_id();
+  for (uint32_t cpu = 0; cpu < MAX_CPUS; ++cpu) {
+    if (cpu != self) call_on(cpu, fn, arg, wait);
+  }
+}
+
+}  // namespace hal::smp
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "hal/smp.hpp"
+#include "x86/common/interrupts/lapic.hpp"
+
+namespace x86::smp {
+
+/// Sits at offset 0 of the cpu's %gs segment. `self` comes first so one %gs relative
+/// load yields the whole area.
+struct PerCpu {
+  PerCpu* self;
+  uint32_t id;
+  uint8_t apic_id;
+  std::atomic<bool> online;
+
+  // Mailbox for `hal::smp::call_on`. `busy` serializes senders, the target clears it
+  // once it copied the call out and bumps `done` after running it.
+  std::atomic_flag busy;
+  hal::smp::CallFn call_fn;
+  void* call_arg;
+  std::atomic<uint32_t> sent;
+  std::atomic<uint32_t> done;
+  uint32_t ipis;
+};
+
+extern PerCpu cpus[hal::smp::MAX_CPUS];
+
+inline PerCpu& this_cpu() noexcept {
+  PerCpu* self;
+  asm("mov %%gs:0, %0" : "=r"(self));
+  return *self;
+}
+
+/// Route the call vector. Until then only the boot cpu is online and calls stay local.
+void init_ipi(interrupts::LocalApic& lapic) noexcept;
+
+/// Bring-up of `cpu` finished, it takes calls from now on.
+void mark_online(uint32_t cpu) noexcept;
+
+}  // namespace x86::smp
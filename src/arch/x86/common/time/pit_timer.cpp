@@ -0,0 +1,150 @@
+#include "x86/common/time/pit_timer.hpp"
+
+#include <cstdint>
+
+#include <kernel/log.hpp>
+
+#include "hal/cpu_features.hpp"
+#include "hal/cycles.hpp"
+#include "sched/sched.hpp"
+
+namespace x86::time {
+
+namespace {
+
+// Port 0x61
+constexpr uint8_t Gate2 = 0x01;
+constexpr uint8_t Speaker = 0x02;
+constexpr uint8_t Out2 = 0x20;
+
+// Mode/command register
+constexpr uint8_t Channel0 = 0x00;
+constexpr uint8_t Channel2 = 0x80;
+constexpr uint8_t LoHi = 0x30;
+constexpr uint8_t OneShot = 0x00;  // Mode 0, interrupt on terminal count
+constexpr uint8_t RateGen = 0x04;  // Mode 2
+
+// Anything shorter may fire before the reload has even finished
+constexpr uint32_t MinCount = 16;
+
+constexpr uint32_t CalibrationMs = 10;
+constexpr uint32_t CalibrationRuns = 3;
+
+void irq_trampoline(void* ctx) {
+  static_cast<PitTimer*>(ctx)->handle_irq();
+}
+
+}  // namespace
+
+void PitTimer::init(uint32_t frequency_hz) noexcept {
+  const uint32_t rate = calibrate_tsc();
+  ns_to_count = math::Scale::between(1'000'000'000, BaseHz);
+
+  ic.register_irq(Irq, &irq_trampoline, this);
+
+  // Cycle counts still need the rate, but only a TSC that keeps going through `hlt` and
+  // P-state changes can keep the time while idle waits on one-shot deadlines
+  if (rate) hal::cpu::set_cycles_khz(rate);
+  if (rate && hal::cpu::features().has(hal::cpu::Feature::InvariantTsc)) {
+    // The TSC keeps the time, channel 0 only fires for armed deadlines
+    khz = rate;
+  } else {
+    if (rate) LOG_WARN(Boot, "clock: TSC is not invariant, keeping the periodic tick");
+
+    if (!frequency_hz) frequency_hz = 100;
+
+    uint32_t divisor = (BaseHz + frequency_hz / 2) / frequency_hz;
+    if (divisor < 2) divisor = 2;
+    if (divisor > 0xFFFF) divisor = 0xFFFF;
+    tick_ns = static_cast<uint32_t>((uint64_t{divisor} * 1'000'000'000 + BaseHz / 2) /
+                                    BaseHz);
+
+    hal::irq::Guard guard;
+    command.out(Channel0 | LoHi | RateGen);
+    channel0.out(static_cast<uint8_t>(divisor));
+    channel0.out(static_cast<uint8_t>(divisor >> 8));
+  }
+
+  ic.enable_irq(Irq);
+}
+
+void PitTimer::arm_oneshot(uint64_t deadline_ns) noexcept {
+  // The periodic tick already wakes the cpu often enough
+  if (!tickless()) return;
+
+  const uint64_t now = now_ns();
+  const uint64_t delta = deadline_ns > now ? deadline_ns - now : 0;
+
+  // Round up so the interrupt never lands before the deadline. Beyond ~55 ms the count
+  // saturates and the waiter arms again after the early wakeup.
+  uint64_t count = ns_to_count.apply(delta) + 1;
+  if (count < MinCount) count = MinCount;
+  if (count > 0xFFFF) count = 0xFFFF;
+
+  hal::irq::Guard guard;
+  command.out(Channel0 | LoHi | OneShot);
+  channel0.out(static_cast<uint8_t>(count));
+  channel0.out(static_cast<uint8_t>(count >> 8));
+}
+
+uint32_t PitTimer::calibrate_tsc() const noexcept {
+  if (!hal::cpu::features().has(hal::cpu::Feature::Tsc)) return 0;
+
+  constexpr uint16_t count = BaseHz * CalibrationMs / 1000;
+
+  // Interrupts and SMIs only ever stretch a window, so the shortest one is the truth
+  uint64_t best = UINT64_MAX;
+  for (uint32_t run = 0; run < CalibrationRuns; ++run) {
+    const uint64_t cycles = pit_window_cycles(count);
+    if (cycles && cycles < best) best = cycles;
+  }
+  if (best == UINT64_MAX) return 0;
+
+  return static_cast<uint32_t>(best * BaseHz / (uint64_t{count} * 1000));
+}
+
+uint64_t PitTimer::pit_window_cycles(uint16_t count) const noexcept {
+  hal::irq::Guard guard;
+
+  // Gate channel 2 on with the speaker disconnected, then count down once in mode 0.
+  // OUT2 goes high on terminal count.
+  gate.out(static_cast<uint8_t>((gate.in() & ~Speaker) | Gate2));
+  command.out(Channel2 | LoHi | OneShot);
+  channel2.out(static_cast<uint8_t>(count));
+  channel2.out(static_cast<uint8_t>(count >> 8));
+
+  const uint64_t start = hal::cpu::cycles();
+  // A PIT that never fires would hang boot, give up after far more than the window
+  for (uint32_t spins = 0; (gate.in() & Out2) == 0; ++spins) {
+    if (spins > 10'000'000) return 0;
+  }
+  return hal::cpu::cycles() - start;
+}
+
+void PitTimer::set_handler(HandlerFn fn, void* ctx) noexcept {
+  hal::irq::Guard guard;
+  handler = fn;
+  handler_ctx = ctx;
+}
+
+void PitTimer::handle_irq() noexcept {
+  ++tick_count;
+  if (handler) handler(handler_ctx);
+}
+
+uint64_t PitTimer::ticks() const noexcept {
+  // No 64 bit atomic loads on i386, keep the tick out while both halves are read
+  hal::irq::Guard guard;
+  return tick_count;
+}
+
+uint64_t PitTimer::now_ns() const noexcept {
+  if (khz) return hal::cpu::cycles_to_ns(hal::cpu::cycles());
+  return ticks() * tick_ns;
+}
+
+void PitTimer::sleep_ms(uint32_t ms) noexcept {
+  sched::sleep_until(now_ns() + uint64_t{ms} * 1'000'000);
+}
+
+}  // namespace x86::time
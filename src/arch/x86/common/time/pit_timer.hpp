@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "hal/timer.hpp"
+#include "math/scale.hpp"
+#include "x86/common/io/ports.hpp"
+
+namespace x86::time {
+
+/// The 8254 PIT as the wakeup source and, where the cpu has an invariant one, the TSC as
+/// the clock. `init` measures the TSC against PIT channel 2 and hands the rate to
+/// hal::cpu::set_cycles_khz, so `now_ns` is a TSC read and a mult/shift. Channel 0 then
+/// stays silent until a deadline is armed, one interrupt per deadline. Without an
+/// invariant TSC the clock falls back to counting a periodic tick.
+class PitTimer final : public hal::Timer {
+ public:
+  PitTimer(const PitTimer&) = delete;
+  PitTimer(PitTimer&&) = delete;
+  PitTimer& operator=(const PitTimer&) = delete;
+  PitTimer& operator=(PitTimer&&) = delete;
+
+  explicit PitTimer(hal::InterruptController& ic) noexcept : ic(ic) {}
+
+  static constexpr uint32_t BaseHz = 1'193'182;
+  static constexpr hal::Interrupt Irq{0};
+
+  void init(uint32_t frequency_hz) noexcept override;
+  void arm_oneshot(uint64_t deadline_ns) noexcept override;
+  void set_handler(HandlerFn fn, void* ctx) noexcept override;
+  uint64_t ticks() const noexcept override;
+  uint64_t now_ns() const noexcept override;
+  void sleep_ms(uint32_t ms) noexcept override;
+
+  void handle_irq() noexcept;
+
+  /// TSC rate the clock runs on, 0 while it counts a periodic tick.
+  uint32_t tsc_khz() const noexcept { return khz; }
+
+  bool tickless() const noexcept { return !tick_ns; }
+
+ private:
+  uint32_t calibrate_tsc() const noexcept;
+  uint64_t pit_window_cycles(uint16_t count) const noexcept;
+
+  hal::InterruptController& ic;
+
+  io::Port8 channel0{0x40};
+  io::Port8 channel2{0x42};
+  io::Port8 command{0x43};
+  io::Port8 gate{0x61};
+
+  HandlerFn handler{nullptr};
+  void* handler_ctx{nullptr};
+
+  uint64_t tick_count{0};
+  uint32_t tick_ns{0};  // 0 while tickless
+  math::Scale ns_to_count{};
+  uint32_t khz{0};
+};
+
+}  // namespace x86::time
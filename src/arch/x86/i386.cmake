@@ -3,7 +3,14 @@ set(X86_I386_DIR "${CMAKE_CURRENT_LIST_DIR}/i386")
 list(APPEND ARCH_SOURCES
     ${X86_I386_DIR}/boot/boot.s
     ${X86_I386_DIR}/boot/entry_point.cpp
+    ${X86_I386_DIR}/cpu/cpu.cpp
+    ${X86_I386_DIR}/cpu/gdt.cpp
+    ${X86_I386_DIR}/cpu/switch.s
+    ${X86_I386_DIR}/interrupts/idt.cpp
+    ${X86_I386_DIR}/interrupts/isr.s
     ${X86_I386_DIR}/memory/paging.cpp
+    ${X86_I386_DIR}/smp/smp.cpp
+    ${X86_I386_DIR}/smp/trampoline.s
     ${X86_I386_DIR}/system/system.cpp
 )
 
@@ -10,17 +10,32 @@
 #include "boot/multiboot2.hpp"
 #include "drv/global_core.hpp"
 #include "hal/boot.hpp"
+#include "hal/cycles.hpp"
 #include "hal/serial.hpp"
+#include "hal/smp.hpp"
 #include "kernel.hpp"
 #include "logging/backend/serial.hpp"
 #include "memory/builtin/bm_heap.hpp"
 #include "memory/builtin/bm_page_frame_allocator.hpp"
 #include "memory/heap.hpp"
+#include "sched/idle.hpp"
+#include "x86/common/acpi/acpi.hpp"
 #include "x86/common/board/pc_devices.hpp"
+#include "x86/common/cpu/features.hpp"
 #include "x86/common/drv/register.hpp"
 #include "x86/common/graphics/framebuffer.hpp"
 #include "x86/common/input/keyboard.hpp"
+#include "x86/common/interrupts/ioapic.hpp"
+#include "x86/common/interrupts/lapic.hpp"
+#include "x86/common/interrupts/pic.hpp"
+#include "x86/common/simd/mem_ops.hpp"
+#include "x86/common/smp/percpu.hpp"
+#include "x86/common/time/pit_timer.hpp"
+#include "x86/i386/cpu/cpu.hpp"
+#include "x86/i386/cpu/gdt.hpp"
+#include "x86/i386/interrupts/idt.hpp"
 #include "x86/i386/memory/paging.hpp"
+#include "x86/i386/smp/smp.hpp"
 
 using namespace x86;
 
@@ -134,7 +149,7 @@ inline ::drv::serial::Port* find_console(::drv::GlobalCore& core) noexcept {
         if (de.type != ::drv::TypeTag::of<board::SerialDesc>()) { return false; }
         auto* sd = static_cast<const board::SerialDesc*>(de.ptr);
         if (!sd->name) { return false; }
-        return std::strncmp(sd->name, "com1", 4) == 0;
+        return std::strncmp(sd->name, "com1", 5) == 0;
       });
 
   return p;
@@ -235,6 +250,9 @@ i386::mem::Paging* setup_paging(uint32_t mb2_info_addr, boot::BootContext& ctx)
   // Force nullptr to be invalid
   pfa.reserve_range(0x000000u, PageSize);
 
+  // Application processors start in real mode, their entry code has to stay below 1 MiB
+  pfa.reserve_range(i386::smp::TrampolineAddr, PageSize);
+
   uint32_t kernel_start = 1 * mem::MiB;
   uint32_t kernel_end =
       static_cast<uint32_t>(reinterpret_cast<uintptr_t>(&_ld_kernel_end_addr));
@@ -276,9 +294,30 @@ void make_basic_mem(boot::BootContext& ctx) noexcept {
   if (load_tag<mb2::TagType::BasicMeminfo>(inf)) { ctx.upper_mem_kb = inf.mem_upper; }
 }
 
+/// Local APIC of the boot cpu, needed for IPIs and by the IO APIC. False on machines
+/// without one or without a MADT, those stay on the PIC with a single cpu.
+bool setup_lapic(hal::Paging& paging, x86::acpi::MadtInfo& madt,
+                 x86::interrupts::LocalApic& lapic) noexcept {
+  if (!hal::cpu::has(hal::cpu::Feature::Apic)) return false;
+  if (!x86::acpi::read_madt(paging, madt)) return false;
+  if (!lapic.map(paging, madt.lapic_base)) return false;
+
+  lapic.enable();
+  x86::smp::init_ipi(lapic);
+  return true;
+}
+
 }  // namespace
 
 extern "C" void kmain(uint32_t mb2_info_addr) {
+  x86::cpu::init_features();
+  x86::simd::install_mem_ops(hal::cpu::features());
+
+  i386::cpu::init_gdt();
+  i386::interrupts::init_idt();
+  static x86::interrupts::Pic8259 pic;
+  pic.init();
+
   boot::BootContext ctx{};
   kernel::KernelServices serv{};
 
@@ -301,6 +340,9 @@ extern "C" void kmain(uint32_t mb2_info_addr) {
   auto* serial_sink = setup_logging(*serv.serial);
   logging::backend::set_sink(serial_sink);
 
+  static i386::cpu::Cpu32 cpu;
+  serv.cpu = &cpu;
+
   setup_boot_fb(serv);
   make_basic_mem(ctx);
   make_mem_map(ctx);
@@ -323,6 +365,38 @@ extern "C" void kmain(uint32_t mb2_info_addr) {
   mem::init_heap(kernel_heap, ctx.ram_start_addr, 32 * mem::MiB);
   mem::set_kernel_heap(*kernel_heap);
 
+  // The APIC registers sit far above the identity map, so routing is decided only now
+  static x86::acpi::MadtInfo madt{};
+  static x86::interrupts::LocalApic lapic;
+  static x86::interrupts::IoApic ioapic{lapic};
+  const bool have_lapic = setup_lapic(*serv.paging, madt, lapic);
+
+  serv.interrupt_controller = &pic;
+  if (have_lapic && !kernel::has_option(ctx.cmdline, "noapic") &&
+      ioapic.init(madt, *serv.paging, lapic.id())) {
+    pic.mask_all();
+    serv.interrupt_controller = &ioapic;
+  }
+  LOG_INFO(Boot, "irq: routed through the %s",
+           serv.interrupt_controller == &ioapic ? "IO APIC" : "8259 PIC");
+
+  serv.serial->attach_irq(*serv.interrupt_controller);
+  serv.keyboard->attach_irq(*serv.interrupt_controller);
+  hal::irq::enable();
+
+  static x86::time::PitTimer timer{*serv.interrupt_controller};
+  timer.init(1000);
+  serv.timer = &timer;
+  sched::set_timer(&timer);
+  LOG_INFO(Boot, "clock: TSC at %u kHz, %s", hal::cpu::cycles_khz(),
+           timer.tickless() ? "tickless" : "1000 Hz tick");
+
+  if (have_lapic && madt.cpu_count > 1 && !kernel::has_option(ctx.cmdline, "nosmp")) {
+    i386::smp::start_aps(madt, lapic);
+  }
+  LOG_INFO(Boot, "smp: %u of %u cpus online", hal::smp::cpu_count(),
+           have_lapic ? madt.cpu_count : 1);
+
   kernel::Kernel kernel{serv, ctx};
   kernel.enter();
 
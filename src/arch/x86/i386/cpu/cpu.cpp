@@ -1,34 +1,47 @@
 #include "x86/i386/cpu/cpu.hpp"
 
-namespace i386::cpu {
+#include <cstdint>
 
-bool Cpu32::create_context(hal::CpuContext& context, hal::EntryFn entry, void* arg,
-                           uintptr_t stack_top) const noexcept {
-  Context32 ctx32;
-  auto& r = ctx32.regs;
+extern "C" {
+void context_switch(uintptr_t* save_sp, uintptr_t next_sp);
+void context_start();
+}
 
-  r.edi = 0;
-  r.esi = 0;
-  r.ebp = static_cast<uint32_t>(stack_top);
-  r.ebx = 0;
-  r.edx = 0;
-  r.ecx = 0;
+namespace i386::cpu {
 
-  r.eax = reinterpret_cast<uint32_t>(arg);
-  r.eip = reinterpret_cast<uint32_t>(entry);
+namespace {
+// Stack image `context_switch` pops for a fresh thread, lowest address first
+struct InitialFrame {
+  uint32_t edi;
+  uint32_t esi;  // arg
+  uint32_t ebx;  // entry
+  uint32_t ebp;
+  uint32_t ret;  // context_start
+};
+}  // namespace
 
-  uint32_t eflags = 0;
-  asm volatile("pushf\n\tpop %0" : "=r"(eflags));
-  r.eflags = eflags;
+bool Cpu32::create_context(hal::CpuContext& context, hal::EntryFn entry, void* arg,
+                           uintptr_t stack_top) const noexcept {
+  if (!entry || !stack_top) return false;
 
-  r.cr3 = 0;
+  // cdecl wants esp + 4 16 byte aligned at function entry, context_start pushes one
+  // argument before its call, so leave the top aligned
+  uintptr_t sp = (stack_top & ~uintptr_t{15}) - 12;
+  sp -= sizeof(InitialFrame);
 
-  context = ctx32;
+  auto* frame = reinterpret_cast<InitialFrame*>(sp);
+  frame->edi = 0;
+  frame->esi = reinterpret_cast<uint32_t>(arg);
+  frame->ebx = reinterpret_cast<uint32_t>(entry);
+  frame->ebp = 0;
+  frame->ret = reinterpret_cast<uint32_t>(&context_start);
 
+  context.sp = sp;
   return true;
 }
 
-void Cpu32::switch_to(const hal::CpuContext& last) noexcept {
-  current = *reinterpret_cast<const Context32*>(&last);
+void Cpu32::switch_to(hal::CpuContext& from, const hal::CpuContext& to) noexcept {
+  context_switch(&from.sp, to.sp);
 }
-}  // namespace x86::cpu
+
+}  // namespace i386::cpu
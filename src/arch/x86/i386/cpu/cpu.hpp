@@ -6,34 +6,14 @@
 
 namespace i386::cpu {
 
-struct Regs32 {
-  uint32_t edi;
-  uint32_t esi;
-  uint32_t ebp;
-  uint32_t esp;
-  uint32_t ebx;
-  uint32_t edx;
-  uint32_t ecx;
-  uint32_t eax;
-  uint32_t eip;
-  uint32_t eflags;
-  uint32_t cr3;
-};
-
-class Context32 final : public hal::CpuContext {
- public:
-  Regs32 regs{};
-};
-
+/// Switches by pushing the callee saved registers (ebp, ebx, esi, edi) onto the old
+/// stack and popping them off the new one. Everything else is already saved by the
+/// caller according to the cdecl ABI.
 class Cpu32 final : public hal::Cpu {
  public:
   bool create_context(hal::CpuContext& context, hal::EntryFn entry, void* arg,
                       uintptr_t stack_top) const noexcept override;
-  void switch_to(const hal::CpuContext& next) noexcept override;
-
-  const hal::CpuContext& current_context() noexcept override { return current; }
-
- private:
-  Context32 current;
+  void switch_to(hal::CpuContext& from, const hal::CpuContext& to) noexcept override;
 };
-}  // namespace x86::cpu
+
+}  // namespace i386::cpu
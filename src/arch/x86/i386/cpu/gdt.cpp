@@ -0,0 +1,74 @@
+#include "x86/i386/cpu/gdt.hpp"
+
+#include <cstdint>
+
+#include "hal/smp.hpp"
+#include "x86/common/smp/percpu.hpp"
+
+namespace i386::cpu {
+
+namespace {
+struct [[gnu::packed]] GdtPointer {
+  uint16_t limit;
+  uint32_t base;
+};
+
+constexpr uint64_t make_descriptor(uint32_t base, uint32_t limit, uint8_t access,
+                                   uint8_t flags) noexcept {
+  uint64_t d = 0;
+  d |= limit & 0xFFFFu;
+  d |= static_cast<uint64_t>(base & 0xFFFFFFu) << 16;
+  d |= static_cast<uint64_t>(access) << 40;
+  d |= static_cast<uint64_t>((limit >> 16) & 0xFu) << 48;
+  d |= static_cast<uint64_t>(flags & 0xFu) << 52;
+  d |= static_cast<uint64_t>(base >> 24) << 56;
+  return d;
+}
+
+// Present, ring 0, code: execute/read, data: read/write. 4 KiB granularity, 32 bit.
+constexpr uint8_t CodeAccess = 0x9A;
+constexpr uint8_t DataAccess = 0x92;
+constexpr uint8_t Flat32 = 0xC;
+constexpr uint8_t Bytes32 = 0x4;
+
+// Null, code, data, then one per-cpu segment per cpu, filled in by init_gdt
+alignas(8) uint64_t gdt[3 + hal::smp::MAX_CPUS] = {
+    0,
+    make_descriptor(0, 0xFFFFF, CodeAccess, Flat32),
+    make_descriptor(0, 0xFFFFF, DataAccess, Flat32),
+};
+}  // namespace
+
+void init_gdt() noexcept {
+  for (uint32_t cpu = 0; cpu < hal::smp::MAX_CPUS; ++cpu) {
+    auto& area = x86::smp::cpus[cpu];
+    area.self = &area;
+    area.id = cpu;
+    gdt[per_cpu_selector(cpu) / 8] =
+        make_descriptor(reinterpret_cast<uint32_t>(&area), sizeof(area) - 1, DataAccess,
+                        Bytes32);
+  }
+
+  load_gdt(0);
+}
+
+void load_gdt(uint32_t cpu) noexcept {
+  const GdtPointer ptr{sizeof(gdt) - 1, reinterpret_cast<uint32_t>(&gdt)};
+
+  asm volatile(
+      "lgdt %0\n\t"
+      "ljmp %1, $1f\n"
+      "1:\n\t"
+      "mov %2, %%ax\n\t"
+      "mov %%ax, %%ds\n\t"
+      "mov %%ax, %%es\n\t"
+      "mov %%ax, %%fs\n\t"
+      "mov %%ax, %%ss\n\t"
+      "mov %3, %%gs\n\t"
+      :
+      : "m"(ptr), "i"(KernelCodeSelector), "i"(KernelDataSelector),
+        "r"(per_cpu_selector(cpu))
+      : "eax", "memory");
+}
+
+}  // namespace i386::cpu
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+namespace i386::cpu {
+
+inline constexpr uint16_t KernelCodeSelector = 0x08;
+inline constexpr uint16_t KernelDataSelector = 0x10;
+
+/// %gs of `cpu`, a byte granular data segment covering its x86::smp::PerCpu.
+constexpr uint16_t per_cpu_selector(uint32_t cpu) noexcept {
+  return static_cast<uint16_t>((3 + cpu) * 8);
+}
+
+/// Replace the bootloader's GDT with our own flat one and reload every segment
+/// register. The multiboot spec leaves the selector values up to the loader, so
+/// anything that stores selectors (IDT gates) needs this first. Also sets up the per-cpu
+/// segments and points %gs of the boot cpu at its area.
+void init_gdt() noexcept;
+
+/// Load the GDT `init_gdt` built on another cpu, with %gs on the area of `cpu`.
+void load_gdt(uint32_t cpu) noexcept;
+
+}  // namespace i386::cpu
@@ -0,0 +1,44 @@
+/* src/arch/x86/i386/cpu/switch.s - Kernel thread context switch, see cpu.cpp */
+
+.section .text, "ax"
+.code32
+
+/*
+ * void context_switch(uintptr_t* save_sp, uintptr_t next_sp)
+ *
+ * Only the callee saved registers need to survive the call, they go onto the old
+ * stack and the stack pointer into *save_sp. The new stack holds the same four
+ * registers and a return address.
+ */
+.global context_switch
+.type context_switch, @function
+context_switch:
+    mov 4(%esp), %eax
+    mov 8(%esp), %edx
+
+    push %ebp
+    push %ebx
+    push %esi
+    push %edi
+    mov %esp, (%eax)
+
+    mov %edx, %esp
+    pop %edi
+    pop %esi
+    pop %ebx
+    pop %ebp
+    ret
+.size context_switch, . - context_switch
+
+/*
+ * First return of a fresh thread. ebx holds the entry, esi its argument. Entries never
+ * return, ud2 makes it loud if one does.
+ */
+.global context_start
+.type context_start, @function
+context_start:
+    xor %ebp, %ebp
+    push %esi
+    call *%ebx
+    ud2
+.size context_start, . - context_start
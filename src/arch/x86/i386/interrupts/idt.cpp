@@ -0,0 +1,168 @@
+#include "x86/i386/interrupts/idt.hpp"
+
+#include <cstdint>
+
+#include <kernel/panic.hpp>
+
+#include "hal/cpu_features.hpp"
+#include "hal/smp.hpp"
+#include "x86/common/cpu/features.hpp"
+#include "x86/common/interrupts/vectors.hpp"
+#include "x86/i386/cpu/gdt.hpp"
+
+extern "C" {
+extern uint8_t isr_stubs[];
+uint8_t isr_save_simd;
+uint32_t isr_xsave_size;
+
+void isr_dispatch(i386::interrupts::InterruptFrame* frame);
+}
+
+namespace i386::interrupts {
+
+namespace {
+constexpr uint32_t StubSize = 16;
+constexpr uint8_t InterruptGate = 0x8E;  // Present, ring 0, 32 bit interrupt gate
+
+struct [[gnu::packed]] Gate {
+  uint16_t offset_low;
+  uint16_t selector;
+  uint8_t zero;
+  uint8_t type;
+  uint16_t offset_high;
+};
+
+struct [[gnu::packed]] IdtPointer {
+  uint16_t limit;
+  uint32_t base;
+};
+
+struct Handler {
+  hal::InterruptController::HandlerFn fn;
+  void* ctx;
+};
+
+alignas(8) Gate idt[256];
+Handler handlers[256];
+const InterruptFrame* active_frames[hal::smp::MAX_CPUS]{};
+void (*exit_hook)(){nullptr};
+
+constexpr const char* exception_names[ExceptionCount] = {
+    "Divide error",
+    "Debug",
+    "NMI",
+    "Breakpoint",
+    "Overflow",
+    "Bound range exceeded",
+    "Invalid opcode",
+    "Device not available",
+    "Double fault",
+    "Coprocessor segment overrun",
+    "Invalid TSS",
+    "Segment not present",
+    "Stack-segment fault",
+    "General protection fault",
+    "Page fault",
+    "Reserved",
+    "x87 floating point",
+    "Alignment check",
+    "Machine check",
+    "SIMD floating point",
+    "Virtualization",
+    "Control protection",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Reserved",
+    "Hypervisor injection",
+    "VMM communication",
+    "Security",
+    "Reserved",
+};
+
+[[noreturn]] void unhandled(const InterruptFrame& f) {
+  if (f.vector >= ExceptionCount) {
+    panic("Unhandled interrupt vector %u at eip %x", f.vector, f.eip);
+  }
+
+  uint32_t cr2 = 0;
+  if (f.vector == 14) asm volatile("mov %%cr2, %0" : "=r"(cr2));
+
+  panic("%s (vector %u, error %x) at eip %x, eflags %x, cr2 %x\n"
+        "eax %x ebx %x ecx %x edx %x",
+        exception_names[f.vector], f.vector, f.error, f.eip, f.eflags, cr2, f.eax, f.ebx,
+        f.ecx, f.edx);
+}
+}  // namespace
+
+void init_idt() noexcept {
+  for (uint32_t v = 0; v < 256; ++v) {
+    const uint32_t addr = reinterpret_cast<uint32_t>(isr_stubs) + v * StubSize;
+    idt[v] = {
+        static_cast<uint16_t>(addr),
+        cpu::KernelCodeSelector,
+        0,
+        InterruptGate,
+        static_cast<uint16_t>(addr >> 16),
+    };
+  }
+
+  // fxsave misses the upper YMM halves, with AVX on it has to be xsave
+  isr_xsave_size = x86::cpu::xsave_area_size();
+  if (isr_xsave_size) {
+    isr_save_simd = 2;
+  } else {
+    isr_save_simd = hal::cpu::has(hal::cpu::Feature::Sse) ? 1 : 0;
+  }
+  load_idt();
+}
+
+void load_idt() noexcept {
+  const IdtPointer ptr{sizeof(idt) - 1, reinterpret_cast<uint32_t>(&idt)};
+  asm volatile("lidt %0" ::"m"(ptr) : "memory");
+}
+
+const InterruptFrame* current_frame() noexcept {
+  return active_frames[hal::smp::cpu_id()];
+}
+
+}  // namespace i386::interrupts
+
+namespace x86::interrupts {
+
+bool set_vector_handler(uint8_t vector, hal::InterruptController::HandlerFn handler,
+                        void* ctx) noexcept {
+  if (!handler) return false;
+
+  hal::irq::Guard guard;
+  i386::interrupts::handlers[vector] = {handler, ctx};
+  return true;
+}
+
+}  // namespace x86::interrupts
+
+namespace hal::irq {
+
+void set_exit_hook(void (*hook)()) noexcept {
+  Guard guard;
+  i386::interrupts::exit_hook = hook;
+}
+
+}  // namespace hal::irq
+
+void isr_dispatch(i386::interrupts::InterruptFrame* frame) {
+  using namespace i386::interrupts;
+
+  const auto& h = handlers[frame->vector & 0xFF];
+  if (!h.fn) unhandled(*frame);
+
+  const InterruptFrame*& active = active_frames[hal::smp::cpu_id()];
+  const InterruptFrame* outer = active;
+  active = frame;
+  h.fn(h.ctx);
+  active = outer;
+
+  if (frame->vector >= ExceptionCount && exit_hook) exit_hook();
+}
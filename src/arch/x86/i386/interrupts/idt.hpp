@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+
+namespace i386::interrupts {
+
+/// What isr_common leaves on the stack, lowest address first.
+struct InterruptFrame {
+  uint32_t ebx;
+  uint32_t edx;
+  uint32_t ecx;
+  uint32_t eax;
+  uint32_t vector;
+  uint32_t error;
+  uint32_t eip;
+  uint32_t cs;
+  uint32_t eflags;
+};
+
+inline constexpr uint8_t ExceptionCount = 32;
+
+/// Fill all 256 gates with the entry stubs and load the IDT. Vectors without a handler
+/// panic when they fire, handlers are added with x86::interrupts::set_vector_handler.
+/// The controller specific parts (EOI, spurious checks) are up to whoever registers IRQ
+/// vectors.
+void init_idt() noexcept;
+
+/// Load the IDT `init_idt` filled on another cpu.
+void load_idt() noexcept;
+
+/// Frame of the interrupt being handled on this cpu, nullptr outside of handlers.
+const InterruptFrame* current_frame() noexcept;
+
+}  // namespace i386::interrupts
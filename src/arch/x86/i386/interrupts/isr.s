@@ -0,0 +1,88 @@
+/* src/arch/x86/i386/interrupts/isr.s - Entry stubs for all 256 interrupt vectors */
+
+.section .text, "ax"
+.code32
+
+.extern isr_dispatch
+.extern isr_save_simd
+.extern isr_xsave_size
+
+/*
+ * Every stub is 16 bytes, so the stub of vector N sits at isr_stubs + N * 16. Vectors
+ * where the cpu pushes no error code push a 0 to keep one frame layout.
+ */
+.global isr_stubs
+.balign 16
+isr_stubs:
+.set vec, 0
+.rept 256
+.balign 16
+.if (vec == 8) || (vec == 10) || (vec == 11) || (vec == 12) || (vec == 13) || (vec == 14) || (vec == 17) || (vec == 21) || (vec == 29) || (vec == 30)
+.else
+    push $0
+.endif
+    push $vec
+    jmp isr_common
+.set vec, vec + 1
+.endr
+
+/*
+ * Only the registers a C function may clobber are saved, plus ebx to hold the frame
+ * across the call. SIMD state is saved when the kernel enabled it, since handlers may
+ * end up in the vectorized memory routines and the thread may be switched out before
+ * the iret. isr_save_simd picks how: 1 = fxsave (x87/SSE), 2 = xsave of everything in
+ * XCR0 (adds the upper YMM halves), into isr_xsave_size bytes.
+ */
+isr_common:
+    push %eax
+    push %ecx
+    push %edx
+    push %ebx
+    cld
+
+    mov %esp, %ebx
+    and $-64, %esp
+    movzbl isr_save_simd, %eax
+    cmp $1, %eax
+    jb 1f
+    ja 3f
+    sub $512, %esp
+    fxsave (%esp)
+    jmp 1f
+3:
+    sub isr_xsave_size, %esp
+    /* xrstor faults on a header with stray bits, xsave only writes its first 8 bytes */
+    xor %eax, %eax
+    mov $16, %ecx
+4:
+    mov %eax, 508(%esp, %ecx, 4)
+    loop 4b
+    mov $-1, %eax
+    mov $-1, %edx
+    xsave (%esp)
+1:
+    sub $12, %esp
+    push %ebx
+    call isr_dispatch
+    add $16, %esp
+
+    movzbl isr_save_simd, %eax
+    cmp $1, %eax
+    jb 2f
+    ja 5f
+    fxrstor (%esp)
+    jmp 2f
+5:
+    mov $-1, %eax
+    mov $-1, %edx
+    xrstor (%esp)
+2:
+    mov %ebx, %esp
+    pop %ebx
+    pop %edx
+    pop %ecx
+    pop %eax
+    add $8, %esp
+    iret
+
+.section .note.GNU-stack,"",@progbits
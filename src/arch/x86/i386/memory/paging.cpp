@@ -5,6 +5,7 @@
 #include <cstdio>
 
 #include "hal/paging.hpp"
+#include "trace/trace.hpp"
 
 namespace i386::mem {
 
@@ -167,6 +168,7 @@ bool Paging::map(uintptr_t vaddr, uintptr_t paddr, hal::PageFlags flags) noexcep
 
   uint32_t entry = static_cast<uint32_t>((paddr & PdMask) | hw_flags(flags));
   pt[ti] = entry;
+  trace::emit(trace::Event::PageMap, vaddr, paddr, entry);
   return true;
 }
 
@@ -190,6 +192,7 @@ void Paging::unmap(uintptr_t vaddr) noexcept {
 
   uint32_t* pt = reinterpret_cast<uint32_t*>(static_cast<uintptr_t>(pde & PdMask));
   pt[ti] = 0;
+  trace::emit(trace::Event::PageUnmap, vaddr);
 }
 
 void Paging::unmap_range(uintptr_t vaddr, size_t pages) noexcept {
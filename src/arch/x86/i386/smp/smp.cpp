@@ -0,0 +1,153 @@
+#include "x86/i386/smp/smp.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <kernel/log.hpp>
+
+#include "hal/cycles.hpp"
+#include "hal/interrupts.hpp"
+#include "hal/smp.hpp"
+#include "x86/common/cpu/features.hpp"
+#include "x86/common/io/ports.hpp"
+#include "x86/common/smp/percpu.hpp"
+#include "x86/i386/cpu/gdt.hpp"
+#include "x86/i386/interrupts/idt.hpp"
+
+extern "C" {
+extern uint8_t ap_trampoline_start[];
+extern uint8_t ap_trampoline_end[];
+extern uint8_t ap_tramp_gdtr[];
+extern uint8_t ap_tramp_cr3[];
+extern uint8_t ap_tramp_stack[];
+extern uint8_t ap_tramp_entry[];
+extern uint8_t ap_tramp_cpu[];
+}
+
+namespace i386::smp {
+
+namespace {
+constexpr size_t ApStackSize = 16 * 1024;
+
+// INIT-SIPI-SIPI timing from the MP spec, the second SIPI only goes out when the first
+// did not get the AP going
+constexpr uint32_t InitDelayUs = 10'000;
+constexpr uint32_t FirstSipiWaitUs = 200;
+constexpr uint32_t OnlineTimeoutUs = 100'000;
+
+x86::interrupts::LocalApic* apic{nullptr};
+
+// Index of the AP being started right now, 0 while none is. An AP that shows up after
+// its timeout reads whatever the trampoline holds by then and must not take that slot.
+std::atomic<uint32_t> expected{0};
+
+void delay_us(uint32_t us) noexcept {
+  const uint32_t khz = hal::cpu::cycles_khz();
+  if (!khz) {
+    // Each port 0x80 write takes about a microsecond on the ISA bus
+    for (uint32_t i = 0; i < us; ++i) {
+      x86::io::Port8{0x80}.out(0);
+    }
+    return;
+  }
+
+  const uint64_t end = hal::cpu::cycles() + uint64_t{khz} * us / 1000;
+  while (hal::cpu::cycles() < end) {
+    asm volatile("pause");
+  }
+}
+
+/// The copy of a trampoline slot at TrampolineAddr.
+template <typename T>
+volatile T* slot(uint8_t* label) noexcept {
+  return reinterpret_cast<volatile T*>(TrampolineAddr + (label - ap_trampoline_start));
+}
+
+[[noreturn]] void ap_main(uint32_t cpu) noexcept {
+  if (cpu != expected.load(std::memory_order_acquire) ||
+      apic->id() != x86::smp::cpus[cpu].apic_id) {
+    for (;;) {
+      asm volatile("cli; hlt");
+    }
+  }
+
+  cpu::load_gdt(cpu);
+  interrupts::load_idt();
+  x86::cpu::init_features_ap();
+  apic->enable();
+  x86::smp::mark_online(cpu);
+
+  // The scheduler stays on the boot cpu, this one only serves calls
+  for (;;) {
+    hal::irq::wait();
+  }
+}
+
+bool wait_online(uint32_t cpu, uint32_t timeout_us) noexcept {
+  for (uint32_t waited = 0; waited < timeout_us; waited += 10) {
+    if (x86::smp::cpus[cpu].online.load(std::memory_order_acquire)) return true;
+    delay_us(10);
+  }
+  return x86::smp::cpus[cpu].online.load(std::memory_order_acquire);
+}
+
+bool start_one(uint32_t cpu, uint8_t apic_id) noexcept {
+  // Never freed, an AP that shows up after the timeout may still run on it
+  auto* stack = new uint8_t[ApStackSize];
+  *slot<uint32_t>(ap_tramp_stack) = reinterpret_cast<uint32_t>(stack + ApStackSize);
+  *slot<uint32_t>(ap_tramp_cpu) = cpu;
+  x86::smp::cpus[cpu].apic_id = apic_id;
+  expected.store(cpu, std::memory_order_release);
+
+  apic->send_init(apic_id);
+  delay_us(InitDelayUs);
+
+  apic->send_startup(apic_id, TrampolineAddr >> 12);
+  if (wait_online(cpu, FirstSipiWaitUs)) return true;
+
+  apic->send_startup(apic_id, TrampolineAddr >> 12);
+  if (wait_online(cpu, OnlineTimeoutUs)) return true;
+
+  // Back to waiting for a SIPI, so it cannot start late on the next AP's trampoline
+  // values. Should it get past the trampoline anyway, ap_main finds `expected` moved on.
+  expected.store(0, std::memory_order_release);
+  apic->send_init(apic_id);
+  return false;
+}
+}  // namespace
+
+uint32_t start_aps(const x86::acpi::MadtInfo& madt,
+                   x86::interrupts::LocalApic& lapic) noexcept {
+  apic = &lapic;
+
+  memcpy(reinterpret_cast<void*>(TrampolineAddr), ap_trampoline_start,
+         static_cast<size_t>(ap_trampoline_end - ap_trampoline_start));
+
+  uint32_t cr3;
+  asm volatile("mov %%cr3, %0" : "=r"(cr3));
+  asm volatile("sgdt %0" : "=m"(*slot<uint8_t>(ap_tramp_gdtr)) : : "memory");
+  *slot<uint32_t>(ap_tramp_cr3) = cr3;
+  *slot<uint32_t>(ap_tramp_entry) = reinterpret_cast<uint32_t>(&ap_main);
+
+  const uint8_t self = lapic.id();
+  uint32_t started = 0;
+  // A slot whose AP timed out stays offline, its stack and per-cpu data are never reused
+  for (uint32_t i = 0, next = 1; i < madt.cpu_count && next < hal::smp::MAX_CPUS; ++i) {
+    const uint8_t apic_id = madt.apic_ids[i];
+    if (apic_id == self) continue;
+
+    if (start_one(next, apic_id)) {
+      LOG_INFO(Boot, "smp: cpu %u up (APIC id %u)", next, apic_id);
+      ++started;
+    } else {
+      LOG_WARN(Boot, "smp: APIC id %u did not come up, cpu %u stays offline", apic_id,
+               next);
+    }
+    ++next;
+  }
+  return started;
+}
+
+}  // namespace i386::smp
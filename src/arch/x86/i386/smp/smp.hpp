@@ -0,0 +1,22 @@
+#pragma once
+
+#include <cstdint>
+
+#include "x86/common/acpi/acpi.hpp"
+#include "x86/common/interrupts/lapic.hpp"
+
+namespace i386::smp {
+
+/// Physical page the real mode trampoline is copied to, reserved from the frame
+/// allocator. Startup IPIs take it as a page number.
+inline constexpr uint32_t TrampolineAddr = 0x8000;
+
+/// Start every enabled cpu of the MADT besides the caller with INIT-SIPI-SIPI, one after
+/// the other. Each AP loads the kernel GDT/IDT, enables its SIMD state and local APIC,
+/// reports online and then halts, serving `hal::smp::call_on` requests. Needs the heap
+/// for the AP stacks and a calibrated cycle counter for the delays. Returns how many
+/// came up.
+uint32_t start_aps(const x86::acpi::MadtInfo& madt,
+                   x86::interrupts::LocalApic& lapic) noexcept;
+
+}  // namespace i386::smp
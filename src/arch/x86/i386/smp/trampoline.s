@@ -0,0 +1,84 @@
+/* src/arch/x86/i386/smp/trampoline.s - Real mode entry of the application processors */
+
+.section .text, "ax"
+
+/*
+ * Copied to TRAMPOLINE_BASE below 1 MiB, where the startup IPI points the AP in real
+ * mode with cs = TRAMPOLINE_BASE >> 4 and ip = 0. Everything in here therefore
+ * addresses through TRAMPOLINE_BASE instead of its link address. The boot cpu fills the
+ * slots at the end of the copy before each startup IPI:
+ *   gdtr  - the kernel's GDT as sgdt stores it, it is identity mapped
+ *   cr3   - the kernel page directory, which keeps low memory identity mapped
+ *   stack - top of the AP's boot stack
+ *   entry - void entry(uint32_t cpu), must not return
+ *   cpu   - dense cpu index passed to entry
+ */
+.set TRAMPOLINE_BASE, 0x8000
+.set T_GDTR, TRAMPOLINE_BASE + (ap_tramp_gdtr - ap_trampoline_start)
+.set T_CR3, TRAMPOLINE_BASE + (ap_tramp_cr3 - ap_trampoline_start)
+.set T_STACK, TRAMPOLINE_BASE + (ap_tramp_stack - ap_trampoline_start)
+.set T_ENTRY, TRAMPOLINE_BASE + (ap_tramp_entry - ap_trampoline_start)
+.set T_CPU, TRAMPOLINE_BASE + (ap_tramp_cpu - ap_trampoline_start)
+.set T_PROTECTED, TRAMPOLINE_BASE + (ap_tramp_protected - ap_trampoline_start)
+
+.global ap_trampoline_start
+.global ap_trampoline_end
+.global ap_tramp_gdtr
+.global ap_tramp_cr3
+.global ap_tramp_stack
+.global ap_tramp_entry
+.global ap_tramp_cpu
+
+.code16
+ap_trampoline_start:
+    cli
+    cld
+    xor %ax, %ax
+    mov %ax, %ds
+    lgdtl T_GDTR
+
+    mov %cr0, %eax
+    or $1, %eax
+    mov %eax, %cr0
+    ljmpl $0x08, $T_PROTECTED
+
+.code32
+ap_tramp_protected:
+    mov $0x10, %ax
+    mov %ax, %ds
+    mov %ax, %es
+    mov %ax, %fs
+    mov %ax, %gs
+    mov %ax, %ss
+
+    mov T_CR3, %eax
+    mov %eax, %cr3
+    mov %cr0, %eax
+    or $0x80000000, %eax
+    mov %eax, %cr0
+
+    /* Same alignment a cdecl call from C would leave */
+    mov T_STACK, %esp
+    and $-16, %esp
+    sub $12, %esp
+    mov T_ENTRY, %ecx
+    pushl T_CPU
+    call *%ecx
+    ud2
+
+.balign 4
+ap_tramp_gdtr:
+    .word 0
+    .long 0
+.balign 4
+ap_tramp_cr3:
+    .long 0
+ap_tramp_stack:
+    .long 0
+ap_tramp_entry:
+    .long 0
+ap_tramp_cpu:
+    .long 0
+ap_trampoline_end:
+
+.section .note.GNU-stack,"",@progbits
@@ -2,6 +2,15 @@ set(X86_ROOT "${CMAKE_CURRENT_LIST_DIR}")
 set(X86_COMMON_DIR "${X86_ROOT}/common")
 
 list(APPEND ARCH_SOURCES
+    ${X86_COMMON_DIR}/acpi/acpi.cpp
+    ${X86_COMMON_DIR}/cpu/features.cpp
+    ${X86_COMMON_DIR}/cpu/irq.cpp
+    ${X86_COMMON_DIR}/interrupts/ioapic.cpp
+    ${X86_COMMON_DIR}/interrupts/lapic.cpp
+    ${X86_COMMON_DIR}/interrupts/pic.cpp
+    ${X86_COMMON_DIR}/simd/mem_ops.cpp
+    ${X86_COMMON_DIR}/smp/ipi.cpp
+    ${X86_COMMON_DIR}/time/pit_timer.cpp
     ${X86_COMMON_DIR}/input/keyboard.cpp
     ${X86_COMMON_DIR}/drv/serial_16550/serial_16550.cpp
     ${X86_COMMON_DIR}/drv/register.cpp
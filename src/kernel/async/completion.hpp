@@ -0,0 +1,66 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+#include "async/executor.hpp"
+#include "async/task.hpp"
+
+namespace async {
+
+/// One-shot result delivered by an interrupt handler to one waiting coroutine, the
+/// building block for request/response I/O: submit a request naming the completion,
+/// `co_await` it, the driver's handler calls `complete` with the status. Whichever of
+/// the two comes first, the coroutine sees the result exactly once. `reset` before
+/// reusing it for the next request.
+template <typename T = int32_t>
+class Completion {
+ public:
+  constexpr Completion() noexcept = default;
+
+  Completion(const Completion&) = delete;
+  Completion& operator=(const Completion&) = delete;
+
+  /// Deliver the result. Any context on the boot cpu, at most once per request.
+  void complete(T value) noexcept {
+    result = value;
+    if (state.exchange(Done, std::memory_order_acq_rel) == Waiting) {
+      owner->schedule(waiter);
+    }
+  }
+
+  bool done() const noexcept { return state.load(std::memory_order_acquire) == Done; }
+
+  void reset() noexcept { state.store(Idle, std::memory_order_relaxed); }
+
+  auto operator co_await() noexcept {
+    struct Awaiter {
+      Completion& c;
+
+      bool await_ready() const noexcept { return c.done(); }
+      bool await_suspend(std::coroutine_handle<> self) noexcept {
+        c.waiter.handle = self;
+        c.owner = &executor();
+        uint8_t expected = Idle;
+        // Losing the race means the result is already there, keep running
+        return c.state.compare_exchange_strong(expected, Waiting,
+                                               std::memory_order_acq_rel);
+      }
+      T await_resume() const noexcept { return c.result; }
+    };
+    return Awaiter{*this};
+  }
+
+ private:
+  static constexpr uint8_t Idle = 0;
+  static constexpr uint8_t Waiting = 1;
+  static constexpr uint8_t Done = 2;
+
+  std::atomic<uint8_t> state{Idle};
+  Waiter waiter{};
+  Executor* owner{nullptr};
+  T result{};
+};
+
+}  // namespace async
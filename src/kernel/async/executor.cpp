@@ -0,0 +1,143 @@
+#include "async/executor.hpp"
+
+#include <atomic>
+#include <coroutine>
+#include <cstdint>
+
+#include "async/task.hpp"
+#include "hal/interrupts.hpp"
+#include "sched/idle.hpp"
+#include "sched/sched.hpp"
+
+namespace async {
+
+namespace {
+constexpr uint8_t ExecutorPriority = 3;
+
+Executor shared_executor{"async", ExecutorPriority};
+}  // namespace
+
+void detail::FinalAwaiter::finished(Executor& owner,
+                                    std::coroutine_handle<> self) noexcept {
+  // Still on the executor thread, the frame is not touched again after this
+  ++owner.finished;
+  self.destroy();
+}
+
+bool Executor::start() noexcept {
+  if (thread) return true;
+
+  thread = sched::spawn(executor_name, &thread_main, this, priority);
+  return thread != nullptr;
+}
+
+void Executor::spawn(Task<> task) noexcept {
+  auto handle = task.release();
+  if (!handle) return;
+
+  auto& promise = handle.promise();
+  promise.owner = this;
+  promise.start.handle = handle;
+  spawned.fetch_add(1, std::memory_order_relaxed);
+  schedule(promise.start);
+}
+
+void Executor::schedule(Waiter& waiter) noexcept {
+  ready.push(&waiter);
+  if (thread) sched::wake(thread);
+}
+
+void Executor::on_sleeper_timeout(sched::Timeout& timeout) noexcept {
+  auto* sleeper = static_cast<Sleeper*>(timeout.ctx);
+  sleeper->owner->sleeping.fetch_sub(1, std::memory_order_relaxed);
+  sleeper->owner->schedule(sleeper->waiter);
+}
+
+void Executor::add_sleeper(Sleeper& sleeper, uint64_t deadline_ns) noexcept {
+  sleeper.owner = this;
+  sleeper.timeout.fn = &on_sleeper_timeout;
+  sleeper.timeout.ctx = &sleeper;
+  sleeping.fetch_add(1, std::memory_order_relaxed);
+  sched::add_timeout(sleeper.timeout, deadline_ns);
+}
+
+void Executor::add_poller(Poller& poller) noexcept {
+  // Appended, the oldest waiter gets the first event
+  Poller** link = &pollers;
+  while (*link) {
+    link = &(*link)->next;
+  }
+  poller.next = nullptr;
+  *link = &poller;
+}
+
+void Executor::run_ready() noexcept {
+  while (Waiter* w = ready.pop()) {
+    ++resumes;
+    w->handle.resume();
+  }
+}
+
+void Executor::check_pollers() noexcept {
+  Poller** link = &pollers;
+  while (*link) {
+    Poller* p = *link;
+    if (p->ready(*p)) {
+      *link = p->next;
+      ready.push(&p->waiter);
+    } else {
+      link = &p->next;
+    }
+  }
+}
+
+void Executor::wait() noexcept {
+  // Interrupts stay off from the check until the thread is off the cpu, so a `schedule`
+  // from a handler either shows up in the check or finds the thread blocked
+  hal::irq::disable();
+  if (!ready.empty()) {
+    hal::irq::enable();
+    return;
+  }
+
+  ++wakeups;
+  if (pollers) {
+    sched::wait_for_interrupt();
+    return;
+  }
+  sched::block();
+  hal::irq::enable();
+}
+
+void Executor::thread_main(void* arg) noexcept {
+  auto* self = static_cast<Executor*>(arg);
+  for (;;) {
+    self->run_ready();
+    self->check_pollers();
+    self->wait();
+  }
+}
+
+Executor::Stats Executor::stats() const noexcept {
+  hal::irq::Guard guard;
+  Stats st{};
+  st.spawned = spawned.load(std::memory_order_relaxed);
+  st.finished = finished;
+  st.resumes = resumes;
+  st.wakeups = wakeups;
+  st.sleepers = sleeping.load(std::memory_order_relaxed);
+  for (const Poller* p = pollers; p; p = p->next) {
+    ++st.pollers;
+  }
+  return st;
+}
+
+Executor& executor() noexcept {
+  return shared_executor;
+}
+
+void init() noexcept {
+  shared_executor.start();
+}
+
+}  // namespace async
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+
+#include "async/task.hpp"
+#include "containers/mpsc_queue.hpp"
+#include "sched/idle.hpp"
+#include "sched/sched.hpp"
+
+namespace async {
+
+/// Something a coroutine waits for that nothing signals, checked again after every
+/// interrupt while it is pending (a key in a driver ring, a status bit).
+struct Poller {
+  using ReadyFn = bool (*)(Poller& self);
+
+  Waiter waiter{};
+  ReadyFn ready{nullptr};
+  Poller* next{nullptr};
+};
+
+/// A coroutine sleeping on a scheduler timeout, which reschedules it when it fires.
+struct Sleeper {
+  Waiter waiter{};
+  sched::Timeout timeout{nullptr, nullptr};
+  Executor* owner{nullptr};
+};
+
+/// Runs coroutines on one kernel thread. They only switch at `co_await`, so code
+/// between two awaits needs no locking against other coroutines of the same executor.
+/// The thread sleeps while nothing is ready: `schedule` (fine from interrupt handlers and
+/// timeouts) wakes it, and while pollers wait so does every interrupt.
+class Executor {
+ public:
+  struct Stats {
+    uint64_t spawned;
+    uint64_t finished;
+    uint64_t resumes;
+    uint64_t wakeups;  // Times the thread went to sleep and came back
+    uint32_t sleepers;
+    uint32_t pollers;
+  };
+
+  constexpr Executor(const char* name, uint8_t priority) noexcept
+      : executor_name(name), priority(priority) {}
+
+  Executor(const Executor&) = delete;
+  Executor& operator=(const Executor&) = delete;
+
+  /// Spawn the executor thread. Tasks spawned before start right after.
+  bool start() noexcept;
+
+  /// Run `task` on this executor until it finishes, its frame is freed then. Any thread.
+  void spawn(Task<> task) noexcept;
+
+  /// Queue a suspended coroutine to be resumed. Any context on the boot cpu, including
+  /// interrupt handlers.
+  void schedule(Waiter& waiter) noexcept;
+
+  /// Resume the coroutine of `sleeper` once `deadline_ns` passed. Executor thread only,
+  /// from `await_suspend`, like `add_poller`.
+  void add_sleeper(Sleeper& sleeper, uint64_t deadline_ns) noexcept;
+  void add_poller(Poller& poller) noexcept;
+
+  const char* name() const noexcept { return executor_name; }
+  Stats stats() const noexcept;
+
+ private:
+  friend struct detail::FinalAwaiter;
+
+  static void thread_main(void* arg) noexcept;
+  static void on_sleeper_timeout(sched::Timeout& timeout) noexcept;
+  void run_ready() noexcept;
+  void check_pollers() noexcept;
+  void wait() noexcept;
+
+  const char* executor_name;
+  uint8_t priority;
+  sched::Thread* thread{nullptr};
+
+  ctr::MpscQueue<Waiter> ready;
+  Poller* pollers{nullptr};
+
+  std::atomic<uint32_t> spawned{0};
+  std::atomic<uint32_t> sleeping{0};
+  uint64_t finished{0};
+  uint64_t resumes{0};
+  uint64_t wakeups{0};
+};
+
+/// Shared executor for drivers and the shell. Started by `init`.
+Executor& executor() noexcept;
+
+/// Start the shared executor. Needs a running scheduler.
+void init() noexcept;
+
+/// Suspend the calling coroutine until `deadline_ns` on the scheduler clock.
+inline auto sleep_until(uint64_t deadline_ns) noexcept {
+  struct Awaiter {
+    uint64_t deadline_ns;
+    Sleeper sleeper{};
+
+    bool await_ready() const noexcept { return sched::now_ns() >= deadline_ns; }
+    void await_suspend(std::coroutine_handle<> self) noexcept {
+      sleeper.waiter.handle = self;
+      executor().add_sleeper(sleeper, deadline_ns);
+    }
+    void await_resume() const noexcept {}
+  };
+  return Awaiter{deadline_ns};
+}
+
+inline auto sleep_ms(uint32_t ms) noexcept {
+  return sleep_until(sched::now_ns() + uint64_t{ms} * 1'000'000);
+}
+
+/// Let the other ready coroutines run first.
+inline auto yield() noexcept {
+  struct Awaiter {
+    Waiter waiter;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> self) noexcept {
+      waiter.handle = self;
+      executor().schedule(waiter);
+    }
+    void await_resume() const noexcept {}
+  };
+  return Awaiter{};
+}
+
+}  // namespace async
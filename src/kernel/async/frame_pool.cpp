@@ -0,0 +1,98 @@
+#include "async/frame_pool.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/panic.hpp>
+
+#include "memory/heap.hpp"
+#include "sync/lock_stats.hpp"
+#include "sync/spinlock.hpp"
+
+namespace async {
+
+namespace {
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+sync::LockStats pool_stats{"async frames"};
+sync::IrqSpinLock pool_lock{&pool_stats};
+
+FreeBlock* free_lists[FRAME_CLASS_COUNT]{};
+FramePoolStats totals{};
+
+int32_t class_for(size_t size) noexcept {
+  for (size_t cls = 0; cls < FRAME_CLASS_COUNT; ++cls) {
+    if (size <= frame_class_sizes[cls]) return static_cast<int32_t>(cls);
+  }
+  return -1;
+}
+
+/// Carve a fresh chunk into blocks of class `cls`. Called with the lock held, the heap
+/// takes its own.
+bool grow(size_t cls) noexcept {
+  auto* chunk = static_cast<uint8_t*>(mem::alloc(FRAME_CHUNK_SIZE));
+  if (!chunk) return false;
+
+  const size_t size = frame_class_sizes[cls];
+  for (size_t off = 0; off + size <= FRAME_CHUNK_SIZE; off += size) {
+    auto* block = reinterpret_cast<FreeBlock*>(chunk + off);
+    block->next = free_lists[cls];
+    free_lists[cls] = block;
+  }
+  ++totals.chunks;
+  return true;
+}
+}  // namespace
+
+void* alloc_frame(size_t size) noexcept {
+  const int32_t cls = class_for(size);
+  if (cls < 0) {
+    void* frame = mem::alloc(size);
+    if (!frame) panic("Out of memory for a %u byte coroutine frame", size);
+    sync::LockGuard guard{pool_lock};
+    ++totals.large;
+    ++totals.allocs;
+    return frame;
+  }
+
+  sync::LockGuard guard{pool_lock};
+  if (!free_lists[cls] && !grow(static_cast<size_t>(cls))) {
+    panic("Out of memory for a %u byte coroutine frame", size);
+  }
+
+  FreeBlock* block = free_lists[cls];
+  free_lists[cls] = block->next;
+
+  if (++totals.live[cls] > totals.peak[cls]) totals.peak[cls] = totals.live[cls];
+  ++totals.allocs;
+  return block;
+}
+
+void free_frame(void* frame, size_t size) noexcept {
+  if (!frame) return;
+
+  const int32_t cls = class_for(size);
+  if (cls < 0) {
+    {
+      sync::LockGuard guard{pool_lock};
+      --totals.large;
+    }
+    mem::free(frame);
+    return;
+  }
+
+  sync::LockGuard guard{pool_lock};
+  auto* block = static_cast<FreeBlock*>(frame);
+  block->next = free_lists[cls];
+  free_lists[cls] = block;
+  --totals.live[cls];
+}
+
+FramePoolStats frame_pool_stats() noexcept {
+  sync::LockGuard guard{pool_lock};
+  return totals;
+}
+
+}  // namespace async
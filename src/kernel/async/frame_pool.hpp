@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace async {
+
+/// Coroutine frame sizes the pool keeps free lists for. Bigger frames come straight from
+/// the kernel heap.
+inline constexpr size_t FRAME_CLASS_COUNT = 5;
+inline constexpr size_t frame_class_sizes[FRAME_CLASS_COUNT] = {128, 256, 512, 1024,
+                                                                2048};
+
+/// Memory the pool takes from the heap at once when a class runs dry. Never given back,
+/// the frames of one request pattern keep getting reused.
+inline constexpr size_t FRAME_CHUNK_SIZE = 16 * 1024;
+
+struct FramePoolStats {
+  uint32_t live[FRAME_CLASS_COUNT];  // Frames handed out right now
+  uint32_t peak[FRAME_CLASS_COUNT];
+  uint32_t chunks;  // Taken from the heap so far
+  uint32_t large;   // Live frames too big for any class
+  uint64_t allocs;
+};
+
+/// Storage for a coroutine frame of `size` bytes. Panics when out of memory, like the
+/// global operator new. Any thread, not from interrupt handlers.
+void* alloc_frame(size_t size) noexcept;
+
+/// Give back a frame, `size` must be what it was allocated with.
+void free_frame(void* frame, size_t size) noexcept;
+
+FramePoolStats frame_pool_stats() noexcept;
+
+}  // namespace async
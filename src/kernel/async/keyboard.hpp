@@ -0,0 +1,37 @@
+#pragma once
+
+#include <coroutine>
+
+#include "async/executor.hpp"
+#include "hal/keyboard.hpp"
+
+namespace async {
+
+/// Suspend the calling coroutine until `kb` has the next key event. Keyboards only
+/// buffer events, so the executor polls the waiter again after every interrupt. Their
+/// event rings have a single reader: only await keys while no thread reads `kb` as well.
+inline auto next_key(hal::Keyboard& kb) noexcept {
+  struct Awaiter {
+    struct KeyPoller : Poller {
+      hal::Keyboard* kb;
+      hal::KeyEvent ev;
+    } poller;
+
+    bool await_ready() noexcept { return poller.kb->poll(poller.ev); }
+    void await_suspend(std::coroutine_handle<> self) noexcept {
+      poller.waiter.handle = self;
+      poller.ready = [](Poller& p) {
+        auto& self = static_cast<KeyPoller&>(p);
+        return self.kb->poll(self.ev);
+      };
+      executor().add_poller(poller);
+    }
+    hal::KeyEvent await_resume() const noexcept { return poller.ev; }
+  };
+
+  Awaiter awaiter{};
+  awaiter.poller.kb = &kb;
+  return awaiter;
+}
+
+}  // namespace async
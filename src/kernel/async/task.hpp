@@ -0,0 +1,175 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <optional>
+#include <utility>
+
+#include <kernel/panic.hpp>
+
+#include "async/frame_pool.hpp"
+#include "containers/mpsc_queue.hpp"
+
+namespace async {
+
+class Executor;
+
+/// A suspended coroutine waiting to be resumed by the executor. Embedded in whatever
+/// suspended it (an awaiter or a promise), so queueing it allocates nothing.
+struct Waiter : ctr::MpscNode {
+  std::coroutine_handle<> handle;
+};
+
+namespace detail {
+
+/// Where a coroutine goes when it finishes: back to whoever awaited it, or, for a task
+/// the executor runs on its own, away.
+struct FinalAwaiter {
+  bool await_ready() const noexcept { return false; }
+
+  template <typename Promise>
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> self) noexcept {
+    auto& promise = self.promise();
+    if (promise.continuation) return promise.continuation;
+    if (promise.owner) finished(*promise.owner, self);
+    return std::noop_coroutine();
+  }
+
+  void await_resume() const noexcept {}
+
+  static void finished(Executor& owner, std::coroutine_handle<> self) noexcept;
+};
+
+struct PromiseBase {
+  // alloc_frame panics instead of failing, like the global operator new
+  static void* operator new(size_t size) { return alloc_frame(size); }
+  static void operator delete(void* frame, size_t size) noexcept {
+    free_frame(frame, size);
+  }
+
+  std::suspend_always initial_suspend() const noexcept { return {}; }
+  FinalAwaiter final_suspend() const noexcept { return {}; }
+  void unhandled_exception() const noexcept { panic("Exception in a coroutine"); }
+
+  std::coroutine_handle<> continuation{};
+  Executor* owner{nullptr};  // Set for tasks spawned on an executor, which free them
+  Waiter start{};
+};
+
+}  // namespace detail
+
+/// Lazily started coroutine. Nothing runs until the task is awaited by another
+/// coroutine or handed to `Executor::spawn`. Frames come from the frame pool, not the
+/// general heap. Awaiting a task transfers straight into it and straight back when it
+/// finishes, so deep await chains use no stack.
+template <typename T = void>
+class [[nodiscard]] Task {
+ public:
+  struct promise_type : detail::PromiseBase {
+    Task get_return_object() noexcept {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    void return_value(T v) noexcept { value.emplace(std::move(v)); }
+
+    std::optional<T> value;
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() noexcept = default;
+  Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle) handle.destroy();
+      handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle) handle.destroy();
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  bool valid() const noexcept { return static_cast<bool>(handle); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      T await_resume() noexcept {
+        if (!handle || !handle.promise().value) panic("Awaited task gave no value");
+        return std::move(*handle.promise().value);
+      }
+    };
+    return Awaiter{handle};
+  }
+
+  /// Give up ownership of the coroutine, for the executor.
+  Handle release() noexcept { return std::exchange(handle, nullptr); }
+
+ private:
+  explicit Task(Handle handle) noexcept : handle(handle) {}
+
+  Handle handle{};
+};
+
+template <>
+class [[nodiscard]] Task<void> {
+ public:
+  struct promise_type : detail::PromiseBase {
+    Task get_return_object() noexcept {
+      return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    void return_void() const noexcept {}
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Task() noexcept = default;
+  Task(Task&& other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+  Task& operator=(Task&& other) noexcept {
+    if (this != &other) {
+      if (handle) handle.destroy();
+      handle = std::exchange(other.handle, nullptr);
+    }
+    return *this;
+  }
+  ~Task() {
+    if (handle) handle.destroy();
+  }
+
+  Task(const Task&) = delete;
+  Task& operator=(const Task&) = delete;
+
+  bool valid() const noexcept { return static_cast<bool>(handle); }
+
+  auto operator co_await() && noexcept {
+    struct Awaiter {
+      Handle handle;
+
+      bool await_ready() const noexcept { return !handle || handle.done(); }
+      std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+        handle.promise().continuation = awaiting;
+        return handle;
+      }
+      void await_resume() const noexcept {}
+    };
+    return Awaiter{handle};
+  }
+
+  Handle release() noexcept { return std::exchange(handle, nullptr); }
+
+ private:
+  explicit Task(Handle handle) noexcept : handle(handle) {}
+
+  Handle handle{};
+};
+
+}  // namespace async
@@ -8,6 +8,7 @@ struct SerialDesc {
   const char* name;
   uintptr_t io_base;
   uint8_t irq;
+  uint32_t baud;
 };
 
 }  // namespace board
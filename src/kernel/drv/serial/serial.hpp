@@ -3,6 +3,8 @@
 #include <cstddef>
 #include <cstdint>
 
+#include "hal/interrupts.hpp"
+
 namespace drv::serial {
 
 class Port {
@@ -12,7 +14,18 @@ class Port {
   virtual bool write_byte(uint8_t b) noexcept = 0;
   virtual bool read_byte(uint8_t& b) noexcept = 0;
   virtual bool write(const uint8_t* data, size_t len) noexcept = 0;
+
+  /// Block until every byte written so far has left the wire.
   virtual void flush() noexcept = 0;
+
+  /// Move the port from polling to interrupts, false if it cannot.
+  virtual bool attach_irq(hal::InterruptController&) noexcept { return false; }
+
+  /// True once received bytes arrive by interrupt, so a reader may halt until they do.
+  virtual bool rx_irq_driven() const noexcept { return false; }
+
+  /// Whether `read_byte` has something to return right now.
+  virtual bool rx_pending() const noexcept = 0;
 };
 
 }  // namespace drv::serial
@@ -6,21 +6,24 @@ namespace hal {
 
 using EntryFn = void (*)(void*);
 
-class CpuContext {
- public:
-  virtual ~CpuContext() = default;
+/// What a switched out thread leaves behind. The registers it needs again are saved on
+/// its own stack, so the stack pointer is all there is.
+struct CpuContext {
+  uintptr_t sp{0};
 };
 
 class Cpu {
  public:
   virtual ~Cpu() = default;
 
+  /// Prepare `context` so that switching to it calls `entry(arg)` on the stack that ends
+  /// at `stack_top`. Starts with interrupts off, `entry` must never return.
   virtual bool create_context(CpuContext& context, EntryFn entry, void* arg,
                               uintptr_t stack_top) const noexcept = 0;
 
-  virtual void switch_to(const CpuContext& next) noexcept = 0;
-
-  virtual const CpuContext& current_context() noexcept = 0;
+  /// Save the running thread into `from` and continue `to` where it left off. Returns
+  /// once some other thread switches back to `from`. Call with interrupts off.
+  virtual void switch_to(CpuContext& from, const CpuContext& to) noexcept = 0;
 };
 
 }  // namespace hal
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+
+#include "logging/logging.hpp"
+
+namespace hal::cpu {
+
+/// Features are only reported once the kernel is able to use them, e.g. SSE2 is not
+/// set before the SSE state has been enabled.
+enum class Feature : uint32_t {
+  None = 0,
+  Tsc = 1u << 0,
+  InvariantTsc = 1u << 1,
+  Pse = 1u << 2,
+  Pge = 1u << 3,
+  Pat = 1u << 4,
+  Apic = 1u << 5,
+  Fxsr = 1u << 6,
+  Sse = 1u << 7,
+  Sse2 = 1u << 8,
+  Sse42 = 1u << 9,
+  Xsave = 1u << 10,
+  Avx = 1u << 11,
+  Avx2 = 1u << 12,
+  Erms = 1u << 13,
+};
+
+inline Feature operator|(Feature a, Feature b) noexcept {
+  return static_cast<Feature>(static_cast<uint32_t>(a) | static_cast<uint32_t>(b));
+}
+
+inline Feature operator&(Feature a, Feature b) noexcept {
+  return static_cast<Feature>(static_cast<uint32_t>(a) & static_cast<uint32_t>(b));
+}
+
+inline Feature& operator|=(Feature& a, Feature b) noexcept {
+  a = a | b;
+  return a;
+}
+
+struct Features final : public logging::Loggable {
+  char vendor[13]{};
+  uint32_t family{0};
+  uint32_t model{0};
+  uint32_t stepping{0};
+  Feature flags{Feature::None};
+
+  bool has(Feature f) const noexcept { return (flags & f) == f; }
+
+  static constexpr const char* fmt() noexcept {
+    return "{vendor=%s, family=%u, model=%u, stepping=%u, flags=%x}";
+  }
+
+  void log_self(logging::format::LineWriter& out) const noexcept override {
+    log_obj<Features>(out, vendor, family, model, stepping, flags);
+  }
+};
+
+/// Detected by the arch layer during early boot. Empty until then.
+const Features& features() noexcept;
+
+inline bool has(Feature f) noexcept {
+  return features().has(f);
+}
+
+}  // namespace hal::cpu
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hal::cpu {
+
+/// Free running cycle counter of this cpu (the TSC on x86). Cheap enough to time single
+/// functions, but the rate is not known until a timer calibrated it. Reads 0 on cpus
+/// without one.
+uint64_t cycles() noexcept;
+
+/// Rate of `cycles`, 0 until a timer calibrated it.
+uint32_t cycles_khz() noexcept;
+void set_cycles_khz(uint32_t khz) noexcept;
+
+/// Convert a cycle count to nanoseconds with a mult/shift pair precomputed by
+/// `set_cycles_khz`. Reads 0 until the rate is known.
+uint64_t cycles_to_ns(uint64_t cycles) noexcept;
+
+}  // namespace hal::cpu
@@ -23,8 +23,8 @@ class Framebuffer : public logging::Loggable {
     return "{w=%u, h=%u, bpp=%u, pitch=%u, v=%u}";
   }
 
-  void log_self() const noexcept override {
-    log_obj<Framebuffer>(get_width(), get_height(), get_bpp(), get_pitch(), valid());
+  void log_self(logging::format::LineWriter& out) const noexcept override {
+    log_obj<Framebuffer>(out, get_width(), get_height(), get_bpp(), get_pitch(), valid());
   }
 };
 
@@ -4,6 +4,7 @@
 
 namespace hal {
 
+/// A line on the interrupt controller (IRQ number), not the cpu vector it ends up on.
 struct Interrupt {
   uint8_t vector;
 };
@@ -20,4 +21,38 @@ class InterruptController {
   virtual void send_eoi(Interrupt line) noexcept = 0;
 };
 
+namespace irq {
+
+void enable() noexcept;
+void disable() noexcept;
+bool enabled() noexcept;
+
+/// Disable interrupts on this cpu and return whether they were on before, for `restore`.
+bool save_and_disable() noexcept;
+void restore(bool was_enabled) noexcept;
+
+/// Enable interrupts and halt until the next one has been handled. Call it with
+/// interrupts off right after finding nothing to do: the two happen as one step, so an
+/// interrupt that arrives after the check still ends the wait.
+void wait() noexcept;
+
+/// Runs at the end of every hardware interrupt, after its handler and still with
+/// interrupts off. The scheduler switches threads from here.
+void set_exit_hook(void (*hook)()) noexcept;
+
+/// Keeps interrupts off on this cpu for the lifetime of the guard.
+class Guard {
+ public:
+  Guard() noexcept : was_enabled(save_and_disable()) {}
+  ~Guard() { restore(was_enabled); }
+
+  Guard(const Guard&) = delete;
+  Guard& operator=(const Guard&) = delete;
+
+ private:
+  bool was_enabled;
+};
+
+}  // namespace irq
+
 }  // namespace hal
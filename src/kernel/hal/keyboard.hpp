@@ -1,6 +1,7 @@
 #pragma once
 #include <cstdint>
 
+#include "hal/interrupts.hpp"
 #include "logging/logging.hpp"
 
 namespace hal {
@@ -235,8 +236,8 @@ struct KeyEvent : logging::Loggable {
 
   inline bool has_only_mod(KeyMod mod) const { return (mods ^ mod) == KeyMod::None; }
 
-  void log_self() const noexcept override {
-    log_obj<KeyEvent>(key, type, mods, scan_code, extended);
+  void log_self(logging::format::LineWriter& out) const noexcept override {
+    log_obj<KeyEvent>(out, key, type, mods, scan_code, extended);
   }
 };
 
@@ -244,6 +245,13 @@ class Keyboard {
  public:
   virtual ~Keyboard() = default;
   virtual bool poll(KeyEvent& ev) noexcept = 0;
+
+  /// Block until the next event. Runs the idle hooks while waiting and halts the cpu in
+  /// between once events arrive by interrupt.
+  virtual void wait_event(KeyEvent& ev) noexcept = 0;
+
+  /// Move the keyboard from polling to interrupts, false if it cannot.
+  virtual bool attach_irq(InterruptController&) noexcept { return false; }
 };
 
 }  // namespace hal
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hal::smp {
+
+inline constexpr uint32_t MAX_CPUS = 8;
+
+using CallFn = void (*)(void* arg);
+
+/// Dense index of the cpu running the caller, the boot cpu is 0. One load from the
+/// per-cpu area, valid from the very first instruction of kmain on.
+uint32_t cpu_id() noexcept;
+
+/// Cpus that finished bring-up, the boot cpu included. Ids stay below MAX_CPUS but may
+/// have gaps where an AP failed to start.
+uint32_t cpu_count() noexcept;
+
+/// Run `fn(arg)` on `cpu` from an interrupt there, with interrupts off. Returns false
+/// when `cpu` is not online. With `wait` the call returns once `fn` finished, so waiting
+/// with interrupts off while the target might be calling back deadlocks. Calls aimed at
+/// the own cpu run right away.
+bool call_on(uint32_t cpu, CallFn fn, void* arg, bool wait = true) noexcept;
+
+/// `call_on` every online cpu but the own one.
+void call_on_others(CallFn fn, void* arg, bool wait = true) noexcept;
+
+}  // namespace hal::smp
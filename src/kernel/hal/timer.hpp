@@ -4,12 +4,32 @@
 
 namespace hal {
 
+/// Monotonic clock plus the interrupt that wakes the cpu up for deadlines.
 class Timer {
  public:
+  using HandlerFn = void (*)(void* ctx);
+
   virtual ~Timer() = default;
 
-  virtual void init(uint32_t frequnecy_hz) noexcept = 0;
+  /// Calibrate the clock. Timers that cannot keep time without one start a periodic tick
+  /// at `frequency_hz`, the others stay quiet until `arm_oneshot`.
+  virtual void init(uint32_t frequency_hz) noexcept = 0;
+
+  /// Raise one interrupt at `deadline_ns`, or as close after it as the hardware gets.
+  /// Replaces any earlier deadline. Deadlines beyond the hardware range fire early, the
+  /// waiter then simply arms again.
+  virtual void arm_oneshot(uint64_t deadline_ns) noexcept = 0;
+
+  /// Called from the timer interrupt for every tick or armed deadline.
+  virtual void set_handler(HandlerFn fn, void* ctx) noexcept = 0;
+
+  /// Timer interrupts since `init`.
   virtual uint64_t ticks() const noexcept = 0;
+
+  /// Nanoseconds since boot, never goes backwards.
+  virtual uint64_t now_ns() const noexcept = 0;
+
+  /// Halts the cpu until at least `ms` have passed instead of spinning.
   virtual void sleep_ms(uint32_t ms) noexcept = 0;
 };
 
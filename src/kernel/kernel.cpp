@@ -3,18 +3,29 @@
 #include <cstring>
 
 #include <kernel/log.hpp>
+#include <kernel/mem_ops.hpp>
 #include <kernel/panic.hpp>
 
+#include "async/executor.hpp"
 #include "boot/boot_context.hpp"
 #include "boot/multiboot2.hpp"
 #include "gfx/canvas.hpp"
 #include "gfx/shapes.hpp"
 #include "gfx/text/textrenderer.hpp"
 #include "hal/boot.hpp"
+#include "hal/cpu_features.hpp"
+#include "hal/smp.hpp"
+#include "hal/system.hpp"
+#include "logging/backend/ring.hpp"
 #include "logging/backend/serial.hpp"
 #include "logging/logging.hpp"
 #include "memory/byte_conversion.hpp"
+#include "sched/bench.hpp"
+#include "sched/idle.hpp"
+#include "sched/sched.hpp"
+#include "sched/workqueue.hpp"
 #include "shell/shell.hpp"
+#include "tty/serial_console.hpp"
 #include "tty/tty.hpp"
 #include "ui/core/text_area.hpp"
 #include "ui/core/window.hpp"
@@ -27,13 +38,59 @@ void kernel_fuse_set() {
   fuse = true;
 }
 
+bool has_option(const char* cmdline, const char* opt) {
+  if (!cmdline) return false;
+
+  const size_t len = strlen(opt);
+  for (const char* p = cmdline; *p;) {
+    while (*p == ' ') {
+      ++p;
+    }
+    if (strncmp(p, opt, len) == 0 && (p[len] == ' ' || p[len] == '\0')) return true;
+    while (*p && *p != ' ') {
+      ++p;
+    }
+  }
+  return false;
+}
+
+[[noreturn]] void run_shell(tty::Display& display, hal::Keyboard& keyboard,
+                           void (*prompt_hook)(void* ctx) = nullptr,
+                           void* hook_ctx = nullptr) {
+  tty::Tty tty{display, keyboard};
+  shell::Shell shell{tty};
+  shell.register_builtin_commands();
+  if (prompt_hook) shell.set_prompt_hook(prompt_hook, hook_ctx);
+
+  shell.run();
+}
+
+// Same priority as normal threads, so waking it never preempts the thread that logs and
+// a burst of lines drains in one go
+sched::WorkQueue log_queue{"logd", sched::DEFAULT_PRIORITY};
+
+using LogRing = logging::backend::RingSink<16 * 1024, 4>;
+LogRing* log_ring{nullptr};
+
 logging::backend::LoggingSink* setup_logging(KernelServices& serv) {
   if (serv.serial) {
     static logging::backend::SerialSink serial_sink(*serv.serial);
+    static LogRing ring;
+    log_ring = &ring;
+    ring.add_sub(&serial_sink);
+    sched::add_idle_hook([](void* ctx) { static_cast<LogRing*>(ctx)->drain(); }, &ring);
+
+    static sched::Work drain_work{[](sched::Work&) { ring.drain(); }};
+    // Work queues belong to the boot cpu, lines from others drain with the next one
+    ring.set_notify(
+        [](void*) {
+          if (hal::smp::cpu_id() == 0) log_queue.queue(drain_work);
+        },
+        nullptr);
     log_msg("");
     log_msg("");
     log_msg("");
-    return &serial_sink;
+    return &ring;
   }
   return nullptr;
 }
@@ -42,44 +99,84 @@ logging::backend::LoggingSink* setup_logging(KernelServices& serv) {
   kernel_fuse_set();
 
   logging::backend::set_sink(setup_logging(services));
+  if (!logging::configure_from_cmdline(ctx.cmdline)) {
+    LOG_DEBUG(Kernel, "No valid log= option, keeping default thresholds");
+  }
+
+  if (!services.cpu) { panic("No cpu operations provided by the arch. Abort!"); }
+  sched::init(*services.cpu);
+  sched::init_work_queues();
+  async::init();
+  log_queue.start();
+
   auto& map = mb2::get_tag_map();
   for (size_t i = 0; i < map.size(); ++i) {
     auto& e = map.data[i];
-    log_msg("%x = k:%x v:%p (Tagsize: %x)", i, static_cast<uint32_t>(e.key), e.value,
-            e.value->size);
+    LOG_DEBUG(Boot, "%x = k:%x v:%p (Tagsize: %x)", i, static_cast<uint32_t>(e.key),
+              e.value, e.value->size);
   }
 
-  log_msg("aanOS kernel entered...");
-  log_msg("Booted by %s", ctx.bootloader_name);
-  log_msg("Bootoptions: %s", ctx.cmdline);
-  log_msg("%d KiB available in upper memory", ctx.upper_mem_kb);
+  LOG_INFO(Kernel, "aanOS kernel entered...");
+  LOG_INFO(Boot, "Booted by %s", ctx.bootloader_name);
+  LOG_INFO(Boot, "Bootoptions: %s", ctx.cmdline);
+  LOG_INFO(Memory, "%d KiB available in upper memory", ctx.upper_mem_kb);
+  LOG_INFO(Kernel, "CPU %o", &hal::cpu::features());
+  LOG_INFO(Kernel, "Using %s memory routines", klibc::mem_ops().name);
 
   if (ctx.memory_map && ctx.memory_regions) {
-    log_msg("Found memory map (%d entries):", ctx.memory_regions);
+    LOG_DEBUG(Memory, "Found memory map (%d entries):", ctx.memory_regions);
     for (size_t i = 0; i < ctx.memory_regions; ++i) {
       auto e = ctx.memory_map[i];
-      log_msg("  %d MiB at %x [%s]", mem::B_to_MiB(e.length), e.addr,
-              boot::MemoryRegionTypeName(e.type));
+      LOG_DEBUG(Memory, "  %d MiB at %x [%s]", mem::B_to_MiB(e.length), e.addr,
+                boot::MemoryRegionTypeName(e.type));
     }
 
-    log_msg("Kernel heap (%d MiB) initialized at %p", 32, ctx.ram_start_addr);
+    LOG_INFO(Memory, "Kernel heap (%d MiB) initialized at %p", 32,
+             reinterpret_cast<void*>(ctx.ram_start_addr));
   }
 
   uintptr_t out;
   hal::PageFlags fl;
-  if (!services.paging->translate(0xFD000000u, out, fl)) { log_msg("FB not mapped!"); }
+  if (!services.paging->translate(0xFD000000u, out, fl)) {
+    LOG_WARN(Memory, "FB not mapped!");
+  }
 
   uint8_t* alloc_test = new uint8_t{3};
-  log_msg("Can allocate test value %u at addr %p", *alloc_test, alloc_test);
+  LOG_DEBUG(Memory, "Can allocate test value %u at addr %p", *alloc_test, alloc_test);
+
+  // Headless runs: results go to serial, `schedbench=shutdown` powers off afterwards
+  const bool bench_then_off = has_option(ctx.cmdline, "schedbench=shutdown");
+  if (bench_then_off || has_option(ctx.cmdline, "schedbench")) {
+    LOG_INFO(Sched, "Running the scheduler benchmarks");
+    if (!sched::bench::run_all()) LOG_WARN(Sched, "Scheduler benchmarks incomplete");
+    if (bench_then_off) {
+      // The results may still sit in the log ring and the serial TX ring
+      logging::backend::flush_final();
+      hal::sys::shutdown();
+    }
+  }
+
+  if (!services.framebuffer || has_option(ctx.cmdline, "console=serial")) {
+    if (!services.serial) { panic("No framebuffer and no serial console. Abort!"); }
+    LOG_INFO(Kernel, "Running the shell on the serial console");
+
+    static tty::SerialDisplay serial_display{*services.serial};
+    static tty::SerialKeyboard serial_keyboard{*services.serial};
+    if (!log_ring) run_shell(serial_display, serial_keyboard);
+
+    // The log shares the port: lines logged while the shell draws would land in the
+    // middle of its escape sequences, so they wait for the next prompt
+    log_ring->set_held(true);
+    run_shell(serial_display, serial_keyboard, [](void*) { log_ring->drain_held(); });
+  }
 
   hal::Framebuffer* fb = services.framebuffer;
-  if (!fb) { panic("No framebuffer provided by bootloader. Abort!"); }
-  log_msg("Got framebuffer(%p) %o", fb->begin(), fb);
+  LOG_INFO(Gfx, "Got framebuffer(%p) %o", fb->begin(), fb);
 
   gfx::Canvas can(*fb);
   can.clear(0xFF202040);
 
-  log_msg("Can write to framebuffer");
+  LOG_DEBUG(Gfx, "Can write to framebuffer");
 
   auto* kb = services.keyboard;
   if (!kb) { panic("No keyboard provided by bootloader. Abort!"); }
@@ -92,10 +189,6 @@ logging::backend::LoggingSink* setup_logging(KernelServices& serv) {
   gfx::text::TextRenderer tr{can, style};
   ui::TextArea tty_area{tty_rect, tr, style};
   ui::TtyTextArea tty_display(tty_area);
-  tty::Tty tty{tty_display, *kb};
-  shell::Shell shell{tty};
-  shell.register_builtin_commands();
-
-  shell.run();
+  run_shell(tty_display, *kb);
 }
 }  // namespace kernel
@@ -2,6 +2,7 @@
 
 #include "boot/boot_context.hpp"
 #include "drv/serial/serial.hpp"
+#include "hal/cpu.hpp"
 #include "hal/framebuffer.hpp"
 #include "hal/interrupts.hpp"
 #include "hal/keyboard.hpp"
@@ -11,6 +12,7 @@
 namespace kernel {
 
 struct KernelServices {
+  hal::Cpu* cpu;
   hal::Framebuffer* framebuffer;
   drv::serial::Port* serial;
 
@@ -20,6 +22,9 @@ struct KernelServices {
   hal::Paging* paging;
 };
 
+/// Whether the space separated `cmdline` contains the word `opt`.
+bool has_option(const char* cmdline, const char* opt);
+
 class Kernel {
  public:
   Kernel(KernelServices& services, boot::BootContext& ctx)
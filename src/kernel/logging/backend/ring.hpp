@@ -0,0 +1,199 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "logging/logging.hpp"
+#include "math/bit_logic.hpp"
+#include "math/int_format.hpp"
+
+namespace logging::backend {
+
+/// Non-blocking log sink. Producers append into a power-of-two ring buffer and return
+/// right away, the bytes reach the subscriber sinks (serial, ...) once `drain` runs from
+/// an idle loop or a worker that `set_notify` kicks. When producers lap the drainer the
+/// oldest bytes are overwritten and counted as dropped.
+///
+/// Producers never wait on each other: they reserve space with one atomic add and only
+/// announce themselves in `writers` while copying. The drainer only reads up to a head
+/// it has seen with no writer in flight and afterwards discards whatever got lapped
+/// while it was copying.
+template <size_t Size, size_t MaxSubCount>
+class RingSink final : public LoggingSink {
+  static_assert(math::ipo2(Size) && Size >= 64, "RingSink size must be a power of two");
+
+ public:
+  RingSink() = default;
+
+  RingSink(const RingSink&) = delete;
+  RingSink(RingSink&&) = delete;
+  RingSink& operator=(const RingSink&) = delete;
+  RingSink& operator=(RingSink&&) = delete;
+
+  /// Subscribers see everything drained after they were added.
+  bool add_sub(LoggingSink* sub) noexcept {
+    if (!sub || sub_count >= MaxSubCount) return false;
+
+    subs[sub_count++] = sub;
+    return true;
+  }
+
+  /// Called after every write in the writer's context, e.g. to queue a drain. Must be
+  /// cheap and safe from interrupt handlers.
+  void set_notify(void (*fn)(void* ctx), void* ctx) noexcept {
+    notify = fn;
+    notify_ctx = ctx;
+  }
+
+  void put_char(char c) const noexcept override { write(&c, 1); }
+
+  void write(const char* data, size_t len) const noexcept override {
+    if (!len) return;
+    if (len > Size) {
+      dropped.fetch_add(static_cast<uint32_t>(len - Size));
+      data += len - Size;
+      len = Size;
+    }
+
+    writers.fetch_add(1);
+    uint32_t pos = head.fetch_add(static_cast<uint32_t>(len));
+    for (size_t i = 0; i < len; ++i) {
+      buffer[(pos + i) & Mask] = data[i];
+    }
+    writers.fetch_sub(1);
+
+    if (notify) notify(notify_ctx);
+  }
+
+  void flush() const noexcept override {
+    forward_pending(true);
+    for (size_t s = 0; s < sub_count; ++s) {
+      subs[s]->flush();
+    }
+  }
+
+  /// Forwards everything up to `head` even with a writer or a drainer preempted half way,
+  /// a write still in flight comes out as far as it got.
+  void flush_final() const noexcept override {
+    const bool was_draining = draining.test_and_set(std::memory_order_acquire);
+
+    uint32_t start = tail;
+    const uint32_t end = head.load();
+    if (end - start > Size) {
+      lapped(end - Size - start);
+      start = end - Size;
+    }
+    while (start != end) {
+      char chunk[ChunkSize];
+      const uint32_t n = end - start < ChunkSize ? end - start : ChunkSize;
+      for (uint32_t i = 0; i < n; ++i) {
+        chunk[i] = buffer[(start + i) & Mask];
+      }
+      forward(chunk, n);
+      start += n;
+    }
+    tail = end;
+
+    // A drainer that got cut off still owns the flag and clears it once it runs again
+    if (!was_draining) draining.clear(std::memory_order_release);
+    for (size_t s = 0; s < sub_count; ++s) {
+      subs[s]->flush_final();
+    }
+  }
+
+  /// While held, `drain` leaves everything in the ring and only `drain_held` and `flush`
+  /// forward it. For a console that shares the subscribers' port and must not have log
+  /// lines cut into its output.
+  void set_held(bool on) noexcept { held.store(on, std::memory_order_release); }
+
+  /// Forward everything buffered so far to the subscribers. Safe to call from several
+  /// places, only one drainer runs at a time and the others return right away.
+  void drain() const noexcept { forward_pending(false); }
+
+  /// `drain` for the owner of a hold, at a point where its output is complete.
+  void drain_held() const noexcept { forward_pending(true); }
+
+  /// Bytes lost to overwrite-oldest or oversized writes since boot.
+  uint32_t dropped_bytes() const noexcept { return dropped.load(); }
+
+ private:
+  static constexpr uint32_t Mask = Size - 1;
+  static constexpr uint32_t ChunkSize = 128;
+
+  void forward_pending(bool ignore_hold) const noexcept {
+    if (draining.test_and_set(std::memory_order_acquire)) return;
+
+    for (;;) {
+      // Checked per chunk, a drain that started before the hold stops at the next one
+      if (!ignore_hold && held.load(std::memory_order_acquire)) break;
+
+      const uint32_t end = head.load();
+      // Bytes below `end` may still be in flight, try again on the next drain
+      if (writers.load() != 0) break;
+
+      uint32_t start = tail;
+      if (end - start > Size) {
+        lapped(end - Size - start);
+        start = end - Size;
+      }
+      if (start == end) break;
+
+      char chunk[ChunkSize];
+      const uint32_t n = end - start < ChunkSize ? end - start : ChunkSize;
+      for (uint32_t i = 0; i < n; ++i) {
+        chunk[i] = buffer[(start + i) & Mask];
+      }
+
+      // Anything a producer reserved a full lap ahead of might be torn
+      const uint32_t now = head.load();
+      uint32_t skip = 0;
+      if (now - start > Size) {
+        skip = now - Size - start < n ? now - Size - start : n;
+        lapped(skip);
+      }
+
+      forward(chunk + skip, n - skip);
+      tail = start + n;
+    }
+
+    draining.clear(std::memory_order_release);
+  }
+
+  void lapped(uint32_t bytes) const noexcept {
+    dropped.fetch_add(bytes);
+
+    char msg[48] = "\n[log: ";
+    size_t len = 7;
+    char digits[math::MAX_INT_DIGITS];
+    char* end = digits + sizeof(digits);
+    for (char* p = math::format_uint(bytes, 10, false, end); p != end; ++p) {
+      msg[len++] = *p;
+    }
+    for (const char* s = " bytes dropped]\n"; *s; ++s) {
+      msg[len++] = *s;
+    }
+    forward(msg, len);
+  }
+
+  void forward(const char* data, size_t len) const noexcept {
+    for (size_t s = 0; s < sub_count; ++s) {
+      subs[s]->write(data, len);
+    }
+  }
+
+  LoggingSink* subs[MaxSubCount]{};
+  size_t sub_count{0};
+
+  void (*notify)(void* ctx){nullptr};
+  void* notify_ctx{nullptr};
+
+  mutable char buffer[Size]{};
+  mutable std::atomic<uint32_t> head{0};
+  mutable std::atomic<uint32_t> writers{0};
+  mutable std::atomic<uint32_t> dropped{0};
+  mutable std::atomic_flag draining{};
+  std::atomic<bool> held{false};
+  mutable uint32_t tail{0};
+};
+
+}  // namespace logging::backend
@@ -1,5 +1,7 @@
 #pragma once
-#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <string.h>
 
 #include "drv/serial/serial.hpp"
 #include "hal/serial.hpp"
@@ -20,6 +22,25 @@ class SerialSink final : public LoggingSink {
     serial.write_byte(static_cast<uint8_t>(c));
   }
 
+  void flush() const noexcept override { serial.flush(); }
+
+  /// Sends whole runs between new lines in one go, the new lines become "\r\n".
+  void write(const char* data, size_t len) const noexcept override {
+    static constexpr uint8_t crlf[] = {'\r', '\n'};
+
+    while (len) {
+      auto* nl = static_cast<const char*>(memchr(data, '\n', len));
+      const size_t run = nl ? static_cast<size_t>(nl - data) : len;
+
+      if (run) serial.write(reinterpret_cast<const uint8_t*>(data), run);
+      if (!nl) break;
+
+      serial.write(crlf, sizeof(crlf));
+      data += run + 1;
+      len -= run + 1;
+    }
+  }
+
  private:
   drv::serial::Port& serial;
 };
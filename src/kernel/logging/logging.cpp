@@ -1,195 +1,248 @@
 #include "logging/logging.hpp"
 
-#include <cstdarg>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "hal/cycles.hpp"
+#include "math/int_format.hpp"
+#include "sync/spinlock.hpp"
 
 namespace logging::internal {
 static backend::LoggingSink* log_sink;
 
-void backend_put_char(char c) noexcept {
-  if (log_sink) { log_sink->put_char(c); }
-}
+Level thresholds[SUBSYSTEM_COUNT] = {
+    Level::Info, Level::Info, Level::Info, Level::Info,
+    Level::Info, Level::Info, Level::Info,
+};
+}  // namespace logging::internal
 
-void backend_put_cstr(const char* s) noexcept {
-  if (!s) { return; }
-  while (*s) {
-    backend_put_char(*s++);
+namespace {
+using logging::Level;
+using logging::Subsystem;
+
+// Every call site may log a burst of RateBurst messages, after that one per
+// 1000 / RatePerSec ms. Until the cycle counter got calibrated its rate is guessed.
+constexpr uint32_t RateBurst = 10;
+constexpr uint32_t RatePerSec = 20;
+constexpr uint32_t FallbackKhz = 1000 * 1000;
+constexpr size_t MaxSites = 64;
+
+static_assert(1000 % RatePerSec == 0);
+
+struct Site {
+  const char* key;
+  uint64_t last_refill;
+  uint32_t tokens;
+  uint32_t suppressed;
+};
+
+using StateGuard = sync::LockGuard<sync::IrqSpinLock>;
+
+// Threads, interrupt handlers and other cpus all log. Everything below is only touched
+// under this lock, the notices go out after it is dropped.
+sync::IrqSpinLock state_lock;
+
+Site sites[MaxSites];
+logging::Stats counters{};
+
+char last_line[logging::format::LineWriter::BufferSize];
+size_t last_len{0};
+uint32_t repeats{0};
+
+Site* find_site(const char* key) noexcept {
+  size_t i = (reinterpret_cast<uintptr_t>(key) >> 2) & (MaxSites - 1);
+  for (size_t n = 0; n < MaxSites; ++n, i = (i + 1) & (MaxSites - 1)) {
+    if (sites[i].key == key) return &sites[i];
+    if (!sites[i].key) {
+      sites[i] = {key, hal::cpu::cycles(), RateBurst, 0};
+      return &sites[i];
+    }
   }
+  return nullptr;
 }
 
-void print_uint(uint64_t value, uint32_t base, bool uppercase) noexcept {
-  if (base < 2 || base > 16) { return; }
+void put_count_line(const char* prefix, uint32_t count, const char* suffix) noexcept {
+  logging::format::LineWriter out;
+  out.put_cstr(prefix);
+  out.put_uint(count, 10, false);
+  out.put_cstr(suffix);
+}
 
-  char buf[32];
-  uint32_t i = 0;
+bool parse_level(std::string_view name, Level& out) noexcept {
+  for (size_t i = 0; i <= static_cast<size_t>(Level::Off); ++i) {
+    if (name == logging::level_names[i]) {
+      out = static_cast<Level>(i);
+      return true;
+    }
+  }
+  return false;
+}
 
-  if (value == 0) {
-    backend_put_char('0');
-    return;
+bool parse_subsystem(std::string_view name, Subsystem& out) noexcept {
+  for (size_t i = 0; i < logging::SUBSYSTEM_COUNT; ++i) {
+    if (name == logging::subsystem_names[i]) {
+      out = static_cast<Subsystem>(i);
+      return true;
+    }
   }
+  return false;
+}
 
-  const char* digits = uppercase ? "0123456789ABCDEF" : "0123456789abcdef";
+// substr() may throw, so views are only ever cut with these
+std::string_view head_until(std::string_view sv, char delim) noexcept {
+  const size_t pos = sv.find(delim);
+  return {sv.data(), pos == std::string_view::npos ? sv.size() : pos};
+}
 
-  while (value > 0 && i < sizeof(buf)) {
-    uint32_t digit = static_cast<uint32_t>(value % base);
-    buf[i++] = digits[digit];
-    value /= base;
-  }
+std::string_view drop(std::string_view sv, size_t count) noexcept {
+  sv.remove_prefix(count < sv.size() ? count : sv.size());
+  return sv;
+}
 
-  while (i > 0) {
-    backend_put_char(buf[--i]);
+bool apply_entry(std::string_view entry) noexcept {
+  Level level;
+  const size_t colon = entry.find(':');
+
+  if (colon == std::string_view::npos) {
+    if (!parse_level(entry, level)) return false;
+    for (auto& t : logging::internal::thresholds) {
+      t = level;
+    }
+    return true;
   }
+
+  Subsystem sys;
+  if (!parse_subsystem(head_until(entry, ':'), sys)) return false;
+  if (!parse_level(drop(entry, colon + 1), level)) return false;
+  logging::set_threshold(sys, level);
+  return true;
 }
+}  // namespace
 
-void print_int(int64_t value) noexcept {
-  if (value < 0) {
-    backend_put_char('-');
-    uint64_t mag = static_cast<uint64_t>(-value);
-    print_uint(mag, 10, false);
-  } else {
-    uint64_t mag = static_cast<uint64_t>(value);
-    print_uint(mag, 10, false);
-  }
+namespace logging {
+
+namespace backend {
+void set_sink(LoggingSink* sink) {
+  internal::log_sink = sink;
+}
+
+void flush() noexcept {
+  if (internal::log_sink) { internal::log_sink->flush(); }
+}
+
+void flush_final() noexcept {
+  if (internal::log_sink) { internal::log_sink->flush_final(); }
 }
+}  // namespace backend
+
+namespace internal {
+bool admit(const char* site) noexcept {
+  const uint64_t now = hal::cpu::cycles();
+  // Without a cycle counter there is no way to refill, so nothing is limited
+  if (!now || !site) return true;
+
+  const uint32_t khz = hal::cpu::cycles_khz() ? hal::cpu::cycles_khz() : FallbackKhz;
+  const uint64_t per_token = static_cast<uint64_t>(khz) * (1000 / RatePerSec);
+
+  uint32_t suppressed = 0;
+  {
+    StateGuard guard{state_lock};
+    Site* s = find_site(site);
+    if (!s) return true;
 
-void vmsg_impl(bool auto_new_line, const char* fmt, va_list args) noexcept {
-  if (!fmt) { return; }
-
-  bool skip_new_line = !auto_new_line;
-  while (*fmt) {
-    char c = *fmt++;
-
-    if (c == '\\') {
-      if (*fmt == '\0') {
-        skip_new_line = true;
-        break;
-      } else {
-        backend_put_char('\\');
-        continue;
-      }
-    } else if (c != '%') {
-      backend_put_char(c);
-      continue;
+    while (s->tokens < RateBurst && now - s->last_refill >= per_token) {
+      s->last_refill += per_token;
+      ++s->tokens;
     }
+    if (s->tokens == RateBurst) s->last_refill = now;
 
-    char spec = *fmt++;
-    if (!spec) {
-      backend_put_char('%');
-      break;
+    if (!s->tokens) {
+      ++s->suppressed;
+      ++counters.rate_limited;
+      return false;
     }
 
-    switch (spec) {
-      case '%': {
-        backend_put_char('%');
-        break;
-      }
-
-      case 'c': {
-        int v = va_arg(args, int);
-        backend_put_char(static_cast<char>(v));
-        break;
-      }
-
-      case 's': {
-        const char* s = va_arg(args, const char*);
-        if (!s) {
-          backend_put_cstr("<null>");
-        } else {
-          backend_put_cstr(s);
-        }
-        break;
-      }
-
-      case 'd':
-      case 'i': {
-        int v = va_arg(args, int);
-        print_int(static_cast<int64_t>(v));
-        break;
-      }
-
-      case 'u': {
-        unsigned int v = va_arg(args, unsigned int);
-        print_uint(static_cast<uint64_t>(v), 10, false);
-        break;
-      }
-
-      case 'x': {
-        //   unsigned int v = va_arg(args, unsigned int);
-        //   backend_put_cstr("0x");
-        //   print_uint(static_cast<uint64_t>(v), 16, false);
-        //   break;
-        // }
-        //
-        // case 'X': {
-        unsigned int v = va_arg(args, unsigned int);
-        backend_put_cstr("0x");
-        print_uint(static_cast<uint64_t>(v), 16, true);
-        break;
-      }
-      case 'b': {
-        unsigned int v = va_arg(args, unsigned int);
-        backend_put_cstr("0b");
-        print_uint(static_cast<uint64_t>(v), 2, true);
-        break;
-      }
-      case 'p': {
-        void* ptr = va_arg(args, void*);
-        if (ptr) {
-          uintptr_t v = reinterpret_cast<uintptr_t>(ptr);
-          backend_put_cstr("0x");
-          print_uint(static_cast<uint64_t>(v), 16, false);
-        } else {
-          backend_put_cstr("<null>");
-        }
-        break;
-      }
-
-      case 'o': {
-        auto* obj = va_arg(args, Loggable*);
-        if (obj) {
-          obj->log_self();
-        } else {
-          backend_put_cstr("<null>");
-        }
-        break;
-      }
-
-      default: {
-        backend_put_char('%');
-        backend_put_char(spec);
-        break;
-      }
+    --s->tokens;
+    suppressed = s->suppressed;
+    s->suppressed = 0;
+  }
+
+  if (suppressed) {
+    put_count_line("[log: ", suppressed, " messages from this call site suppressed]\n");
+  }
+  return true;
+}
+
+bool repeated(const char* line, size_t len) noexcept {
+  uint32_t ended_run = 0;
+  {
+    StateGuard guard{state_lock};
+    if (len == last_len && memcmp(line, last_line, len) == 0) {
+      ++repeats;
+      ++counters.repeats;
+      return true;
     }
+
+    ended_run = repeats;
+    repeats = 0;
+    memcpy(last_line, line, len);
+    last_len = len;
   }
 
-  if (!skip_new_line) { backend_put_char('\n'); }
+  if (ended_run) put_count_line("[log: last message repeated ", ended_run, " times]\n");
+  return false;
 }
+}  // namespace internal
 
-}  // namespace logging::internal
+Stats stats() noexcept {
+  StateGuard guard{state_lock};
+  return counters;
+}
 
-namespace logging {
+void set_threshold(Subsystem sys, Level level) noexcept {
+  internal::thresholds[static_cast<size_t>(sys)] = level;
+}
 
-namespace backend {
-void set_sink(LoggingSink* sink) {
-  internal::log_sink = sink;
+Level threshold(Subsystem sys) noexcept {
+  return internal::thresholds[static_cast<size_t>(sys)];
 }
 
-void log_obj(const char* fmt, ...) {
-  va_list args;
-  va_start(args, fmt);
-  internal::vmsg_impl(false, fmt, args);
-  va_end(args);
+bool configure(std::string_view spec) noexcept {
+  while (!spec.empty()) {
+    const std::string_view entry = head_until(spec, ',');
+    if (!apply_entry(entry)) return false;
+    spec = drop(spec, entry.size() + 1);
+  }
+  return true;
 }
-}  // namespace backend
-}  // namespace logging
 
-void log_msg(const char* fmt, ...) {
-  va_list args;
-  va_start(args, fmt);
-  logging::internal::vmsg_impl(true, fmt, args);
-  va_end(args);
+bool configure_from_cmdline(const char* cmdline) noexcept {
+  if (!cmdline) return false;
+
+  std::string_view rest{cmdline, strlen(cmdline)};
+  while (!rest.empty()) {
+    const std::string_view opt = head_until(rest, ' ');
+    if (opt.starts_with("log=")) return configure(drop(opt, 4));
+    rest = drop(rest, opt.size() + 1);
+  }
+  return false;
+}
+
+void put_tag(format::LineWriter& out, Subsystem sys, Level level) noexcept {
+  static constexpr char letters[] = {'T', 'D', 'I', 'W', 'E'};
+
+  out.put_char('[');
+  out.put_char(letters[static_cast<size_t>(level)]);
+  out.put_char(' ');
+  out.put_cstr(subsystem_names[static_cast<size_t>(sys)]);
+  out.put_chars("] ", 2);
 }
 
-void log_msg(const char* fmt, va_list args) {
-  logging::internal::vmsg_impl(true, fmt, args);
+namespace format {
+void sink_write(const char* data, size_t len) noexcept {
+  if (internal::log_sink) { internal::log_sink->write(data, len); }
 }
+}  // namespace format
+}  // namespace logging
@@ -1,7 +1,13 @@
 #pragma once
 
 #include <concepts>
-#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <type_traits>
+
+#include <kernel/log.hpp>
+#include <kernel/log_format.hpp>
 
 namespace logging {
 namespace backend {
@@ -10,13 +16,43 @@ class LoggingSink {
  public:
   virtual ~LoggingSink() = default;
   virtual void put_char(char c) const noexcept = 0;
+  virtual void write(const char* data, size_t len) const noexcept {
+    for (size_t i = 0; i < len; ++i) {
+      put_char(data[i]);
+    }
+  }
+  /// Push out anything the sink holds back.
+  virtual void flush() const noexcept {}
+  /// `flush` for the way down. Whoever was in the middle of a write or a drain may never
+  /// run again, so nothing may wait for them.
+  virtual void flush_final() const noexcept { flush(); }
 };
 
 void set_sink(LoggingSink* sink);
-
-void log_obj(const char* fmt, ...);
+void flush() noexcept;
+/// Before a panic halts or the system powers off.
+void flush_final() noexcept;
 }  // namespace backend
 
+/// Leveled messages that never made it to the sink.
+struct Stats {
+  uint32_t rate_limited;
+  uint32_t repeats;
+};
+
+Stats stats() noexcept;
+
+void set_threshold(Subsystem sys, Level level) noexcept;
+Level threshold(Subsystem sys) noexcept;
+
+/// Apply a comma separated list of `[subsystem:]level` entries, e.g. "warn,mem:debug".
+/// Entries without a subsystem apply to all of them. Entries are applied in order and
+/// parsing stops at the first bad one, returns false in that case.
+bool configure(std::string_view spec) noexcept;
+
+/// Looks for a `log=<spec>` option on the kernel command line and applies it.
+bool configure_from_cmdline(const char* cmdline) noexcept;
+
 class Loggable;
 
 template <typename O>
@@ -25,17 +61,20 @@ concept LoggableObject = std::derived_from<O, Loggable> && requires {
 };
 
 /// @note When implementing the `log_self` method, just call `log_obj` like this:
-/// log_obj<T>(Args...); where the args are in the same order as given by the fmt
+/// log_obj<T>(out, Args...); where the args are in the same order as given by the fmt.
+/// `out` is the line that asked for the object with %o.
+/// The fmt is checked against the args at compile time, same as for log_msg.
 class Loggable {
  public:
   virtual ~Loggable() = default;
 
-  virtual void log_self() const noexcept = 0;
+  virtual void log_self(format::LineWriter& out) const noexcept = 0;
 
  protected:
   template <LoggableObject O, typename... Args>
-  void log_obj(Args&&... args) const noexcept {
-    logging::backend::log_obj(O::fmt(), std::forward<Args>(args)...);
+  void log_obj(format::LineWriter& out, const Args&... args) const noexcept {
+    static constexpr format::FormatString<Args...> fmt{O::fmt()};
+    format::write(out, fmt, args...);
   }
 };
 }  // namespace logging
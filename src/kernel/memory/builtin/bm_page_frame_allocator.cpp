@@ -4,6 +4,8 @@
 #include <cstdint>
 #include <cstring>
 
+#include "trace/trace.hpp"
+
 namespace mem::builtin {
 
 void BmPageFrameAllocator::init(void* bitmap_storage, size_t bitmap_bytes,
@@ -106,6 +108,7 @@ uintptr_t BmPageFrameAllocator::alloc_frame() noexcept {
     if (!bit_test(i)) {
       bit_set(i);
       hint = i + 1;
+      trace::emit(trace::Event::FrameAlloc, base + i * PageSize);
       return base + static_cast<uintptr_t>(i * PageSize);
     }
   }
@@ -114,6 +117,7 @@ uintptr_t BmPageFrameAllocator::alloc_frame() noexcept {
     if (!bit_test(i)) {
       bit_set(i);
       hint = i + 1;
+      trace::emit(trace::Event::FrameAlloc, base + i * PageSize);
       return base + static_cast<uintptr_t>(i * PageSize);
     }
   }
@@ -127,6 +131,7 @@ void BmPageFrameAllocator::free_frame(uintptr_t addr) noexcept {
   if (i >= frames) return;
   bit_clear(i);
   if (i < hint) hint = i;
+  trace::emit(trace::Event::FrameFree, addr);
 }
 
 }  // namespace mem::builtin
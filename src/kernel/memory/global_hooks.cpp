@@ -1,3 +1,5 @@
+#include <new>
+
 #include "memory/heap.hpp"
 #include <kernel/panic.hpp>
 
@@ -27,3 +29,17 @@ void operator delete(void* ptr, size_t) noexcept {
 void operator delete[](void* ptr, size_t) noexcept {
   mem::free(ptr);
 }
+
+// Over-aligned types (cache line separated queues) come through these.
+void* operator new(size_t sz, std::align_val_t align) {
+  if (void* p = mem::alloc(sz, static_cast<size_t>(align))) { return p; }
+  panic("Out of memory");
+}
+
+void operator delete(void* ptr, std::align_val_t) noexcept {
+  mem::free(ptr);
+}
+
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept {
+  mem::free(ptr);
+}
@@ -1,5 +1,8 @@
 #include "memory/heap.hpp"
 
+#include "memory/magazine.hpp"
+#include "trace/trace.hpp"
+
 namespace mem {
 
 namespace {
@@ -14,12 +17,17 @@ Heap* kernel_heap() noexcept {
   return global_kernel_heap;
 }
 
+// Everything goes through the per-cpu magazines, they do the locking for the heap
 void* alloc(size_t size, size_t align) noexcept {
-  return global_kernel_heap ? global_kernel_heap->alloc(size, align) : nullptr;
+  void* ptr = nullptr;
+  if (global_kernel_heap) ptr = magazine::alloc(*global_kernel_heap, size, align);
+  trace::emit(trace::Event::HeapAlloc, reinterpret_cast<uintptr_t>(ptr), size, align);
+  return ptr;
 }
 
 void free(void* ptr) noexcept {
-  if (global_kernel_heap) global_kernel_heap->free(ptr);
+  trace::emit(trace::Event::HeapFree, reinterpret_cast<uintptr_t>(ptr));
+  if (global_kernel_heap) magazine::free(*global_kernel_heap, ptr);
 }
 
 }  // namespace mem
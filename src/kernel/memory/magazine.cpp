@@ -0,0 +1,290 @@
+#include "memory/magazine.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/panic.hpp>
+
+#include "hal/interrupts.hpp"
+#include "hal/smp.hpp"
+#include "sync/lock_stats.hpp"
+#include "sync/spinlock.hpp"
+
+namespace mem::magazine {
+
+namespace {
+/// In front of every block. `offset` leads back to what the heap handed out.
+struct alignas(alignof(max_align_t)) Header {
+  uint32_t tag;
+  uint32_t offset;
+};
+
+constexpr size_t HeaderSize = sizeof(Header);
+constexpr uint32_t TagMagic = 0xA1100000u;
+constexpr uint32_t TagMagicMask = 0xFFFFF000u;
+constexpr uint32_t TagCached = 0x100u;  // Sits in a magazine, freeing it again is a bug
+constexpr uint32_t TagClassMask = 0xFFu;
+constexpr uint32_t LargeClass = 0xFFu;
+
+struct Magazine {
+  Magazine* next;
+  size_t rounds;
+  void* objs[ROUNDS];
+};
+
+/// Only its own cpu touches it, with interrupts off, so it needs no lock.
+struct CpuCache {
+  Magazine* loaded[CLASS_COUNT];
+  Magazine* previous[CLASS_COUNT];
+  Stats stats[CLASS_COUNT];
+};
+
+struct Depot {
+  sync::SpinLock lock;
+  Magazine* full{nullptr};
+  Magazine* empty{nullptr};
+  size_t full_count{0};
+  size_t empty_count{0};
+};
+
+using SpinGuard = sync::LockGuard<sync::SpinLock>;
+
+CpuCache caches[hal::smp::MAX_CPUS]{};
+
+sync::LockStats heap_stats{"heap"};
+sync::LockStats depot_stats[CLASS_COUNT] = {
+    sync::LockStats{"depot 16"},  sync::LockStats{"depot 32"},
+    sync::LockStats{"depot 64"},  sync::LockStats{"depot 128"},
+    sync::LockStats{"depot 256"}, sync::LockStats{"depot 512"},
+};
+static_assert(CLASS_COUNT == 6, "name the depot locks of new classes");
+
+Depot depots[CLASS_COUNT] = {
+    {sync::SpinLock{&depot_stats[0]}}, {sync::SpinLock{&depot_stats[1]}},
+    {sync::SpinLock{&depot_stats[2]}}, {sync::SpinLock{&depot_stats[3]}},
+    {sync::SpinLock{&depot_stats[4]}}, {sync::SpinLock{&depot_stats[5]}},
+};
+sync::IrqSpinLock heap_lock{&heap_stats};
+
+Header& header_of(void* ptr) noexcept {
+  return *reinterpret_cast<Header*>(static_cast<uint8_t*>(ptr) - HeaderSize);
+}
+
+int32_t class_for(size_t size, size_t align) noexcept {
+  if (align > alignof(max_align_t)) return -1;
+  for (size_t cls = 0; cls < CLASS_COUNT; ++cls) {
+    if (size <= class_sizes[cls]) return static_cast<int32_t>(cls);
+  }
+  return -1;
+}
+
+// The heaps keep no locks of their own. Interrupts stay off while holding this one, a
+// handler allocating on the same cpu would spin forever.
+void* heap_alloc(Heap& heap, size_t size, size_t align) noexcept {
+  sync::LockGuard<sync::IrqSpinLock> guard{heap_lock};
+  return heap.alloc(size, align);
+}
+
+void heap_free(Heap& heap, void* raw) noexcept {
+  sync::LockGuard<sync::IrqSpinLock> guard{heap_lock};
+  heap.free(raw);
+}
+
+void* new_object(Heap& heap, size_t cls) noexcept {
+  auto* raw = static_cast<uint8_t*>(
+      heap_alloc(heap, class_sizes[cls] + HeaderSize, alignof(max_align_t)));
+  if (!raw) return nullptr;
+
+  void* obj = raw + HeaderSize;
+  header_of(obj) = {TagMagic | static_cast<uint32_t>(cls), HeaderSize};
+  return obj;
+}
+
+void release_object(Heap& heap, void* obj) noexcept {
+  heap_free(heap, static_cast<uint8_t*>(obj) - header_of(obj).offset);
+}
+
+Magazine* take(Magazine*& list, size_t& count) noexcept {
+  Magazine* mag = list;
+  if (mag) {
+    list = mag->next;
+    --count;
+  }
+  return mag;
+}
+
+bool put(Magazine*& list, size_t& count, Magazine* mag) noexcept {
+  if (count >= DEPOT_LIMIT) return false;
+  mag->next = list;
+  list = mag;
+  ++count;
+  return true;
+}
+
+void* pop(Magazine* mag) noexcept {
+  void* obj = mag->objs[--mag->rounds];
+  header_of(obj).tag &= ~TagCached;
+  return obj;
+}
+
+void push(Magazine* mag, void* obj) noexcept {
+  header_of(obj).tag |= TagCached;
+  mag->objs[mag->rounds++] = obj;
+}
+
+void* alloc_cached(Heap& heap, size_t cls) noexcept {
+  hal::irq::Guard irq_guard;
+  CpuCache& cc = caches[hal::smp::cpu_id()];
+  Magazine*& loaded = cc.loaded[cls];
+  Magazine*& previous = cc.previous[cls];
+  Stats& st = cc.stats[cls];
+
+  if (loaded && loaded->rounds) {
+    ++st.hits;
+    return pop(loaded);
+  }
+  if (previous && previous->rounds) {
+    Magazine* tmp = loaded;
+    loaded = previous;
+    previous = tmp;
+    ++st.hits;
+    return pop(loaded);
+  }
+
+  // Both empty: trade one of them for a full magazine
+  Depot& depot = depots[cls];
+  Magazine* spare = nullptr;
+  {
+    SpinGuard guard{depot.lock};
+    Magazine* full = take(depot.full, depot.full_count);
+    if (full) {
+      if (previous && !put(depot.empty, depot.empty_count, previous)) spare = previous;
+      previous = loaded;
+      loaded = full;
+    }
+  }
+  if (spare) heap_free(heap, spare);
+
+  if (loaded && loaded->rounds) {
+    ++st.depot_swaps;
+    return pop(loaded);
+  }
+
+  ++st.heap_allocs;
+  return new_object(heap, cls);
+}
+
+void free_cached(Heap& heap, void* obj, size_t cls) noexcept {
+  hal::irq::Guard irq_guard;
+  CpuCache& cc = caches[hal::smp::cpu_id()];
+  Magazine*& loaded = cc.loaded[cls];
+  Magazine*& previous = cc.previous[cls];
+  Stats& st = cc.stats[cls];
+
+  if (loaded && loaded->rounds < ROUNDS) {
+    ++st.hits;
+    push(loaded, obj);
+    return;
+  }
+  if (previous && previous->rounds < ROUNDS) {
+    Magazine* tmp = loaded;
+    loaded = previous;
+    previous = tmp;
+    ++st.hits;
+    push(loaded, obj);
+    return;
+  }
+
+  // Both full (or not there yet): park the previous one at the depot, start an empty one
+  Depot& depot = depots[cls];
+  Magazine* fresh = nullptr;
+  Magazine* overflow = nullptr;
+  {
+    SpinGuard guard{depot.lock};
+    fresh = take(depot.empty, depot.empty_count);
+    if (previous && !put(depot.full, depot.full_count, previous)) overflow = previous;
+  }
+
+  if (overflow) {
+    // The depot has enough cached, this batch goes back to the heap
+    while (overflow->rounds) {
+      release_object(heap, pop(overflow));
+      ++st.heap_frees;
+    }
+    if (fresh) {
+      heap_free(heap, overflow);
+    } else {
+      fresh = overflow;
+    }
+  }
+  if (!fresh) {
+    fresh = static_cast<Magazine*>(heap_alloc(heap, sizeof(Magazine), alignof(Magazine)));
+  }
+  if (!fresh) {
+    // previous already went to the depot (or the heap), keep the cache consistent
+    previous = loaded;
+    loaded = nullptr;
+    ++st.heap_frees;
+    release_object(heap, obj);
+    return;
+  }
+
+  fresh->rounds = 0;
+  previous = loaded;
+  loaded = fresh;
+  ++st.depot_swaps;
+  push(loaded, obj);
+}
+}  // namespace
+
+void* alloc(Heap& heap, size_t size, size_t align) noexcept {
+  if (!size) return nullptr;
+  if (align == 0) align = alignof(max_align_t);
+
+  const int32_t cls = class_for(size, align);
+  if (cls >= 0) return alloc_cached(heap, static_cast<size_t>(cls));
+
+  // Large or over-aligned: pad so the header fits in front without breaking `align`
+  const size_t pad = align > HeaderSize ? align : HeaderSize;
+  const size_t raw_align = align > alignof(max_align_t) ? align : alignof(max_align_t);
+  auto* raw = static_cast<uint8_t*>(heap_alloc(heap, size + pad, raw_align));
+  if (!raw) return nullptr;
+
+  void* obj = raw + pad;
+  header_of(obj) = {TagMagic | LargeClass, static_cast<uint32_t>(pad)};
+  return obj;
+}
+
+void free(Heap& heap, void* ptr) noexcept {
+  if (!ptr) return;
+
+  const uint32_t tag = header_of(ptr).tag;
+  if ((tag & TagMagicMask) != TagMagic) panic("Freeing %p, not a heap block", ptr);
+  if (tag & TagCached) panic("Double free of %p", ptr);
+
+  const uint32_t cls = tag & TagClassMask;
+  if (cls == LargeClass) {
+    // Clear the tag, a second free then fails the magic check
+    header_of(ptr).tag = 0;
+    release_object(heap, ptr);
+    return;
+  }
+  if (cls >= CLASS_COUNT) panic("Freeing %p with a corrupt header", ptr);
+
+  free_cached(heap, ptr, cls);
+}
+
+Stats stats(size_t cls) noexcept {
+  Stats sum{};
+  if (cls >= CLASS_COUNT) return sum;
+
+  for (const auto& cc : caches) {
+    sum.hits += cc.stats[cls].hits;
+    sum.depot_swaps += cc.stats[cls].depot_swaps;
+    sum.heap_allocs += cc.stats[cls].heap_allocs;
+    sum.heap_frees += cc.stats[cls].heap_frees;
+  }
+  return sum;
+}
+
+}  // namespace mem::magazine
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "memory/heap.hpp"
+
+namespace mem::magazine {
+
+/// Object sizes served from the per-cpu caches. Anything bigger, or aligned beyond
+/// max_align_t, goes straight to the heap.
+inline constexpr size_t CLASS_COUNT = 6;
+inline constexpr size_t class_sizes[CLASS_COUNT] = {16, 32, 64, 128, 256, 512};
+
+/// Objects per magazine, also the batch a cpu trades with the depot in one go.
+inline constexpr size_t ROUNDS = 16;
+
+/// Full (and empty) magazines the depot keeps per class, beyond that objects go back to
+/// the heap.
+inline constexpr size_t DEPOT_LIMIT = 8;
+
+struct Stats {
+  uint64_t hits;         // Served by the cpu's own magazines
+  uint64_t depot_swaps;  // A magazine traded with the depot
+  uint64_t heap_allocs;  // Nothing cached anywhere, fresh object from the heap
+  uint64_t heap_frees;   // Depot full, object handed back to the heap
+};
+
+/// Allocate from the calling cpu's magazines, refilling from the depot and `heap`. Each
+/// block carries a small header so `free` finds its class again.
+void* alloc(Heap& heap, size_t size, size_t align) noexcept;
+
+/// Free a block from `alloc`. Small ones stay cached on the calling cpu.
+void free(Heap& heap, void* ptr) noexcept;
+
+/// Counters of class `cls` summed over all cpus.
+Stats stats(size_t cls) noexcept;
+
+}  // namespace mem::magazine
@@ -4,6 +4,7 @@
 #include <cstring>
 
 #include <kernel/log.hpp>
+#include <kernel/mem_ops.hpp>
 
 #include "color.hpp"
 #include "gfx/shapes.hpp"
@@ -93,9 +94,7 @@ void Canvas::fitcpy(uint8_t* dest, const uint8_t* src, size_t len) {
 }
 
 void Canvas::fitset(uint32_t* dest, uint32_t val, size_t len) {
-  for (size_t i = 0; i < len; ++i) {
-    dest[i] = val;
-  }
+  klibc::fill32(dest, val, len);
 }
 
 }  // namespace gfx
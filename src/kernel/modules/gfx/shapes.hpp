@@ -26,7 +26,9 @@ struct Point : public logging::Loggable {
   Point& operator+=(Point p);
   Point& operator-=(Point p);
 
-  void log_self() const noexcept override { log_obj<Point>(x, y); }
+  void log_self(logging::format::LineWriter& out) const noexcept override {
+    log_obj<Point>(out, x, y);
+  }
 };
 
 Point operator-(Point a, Point b);
@@ -70,7 +72,9 @@ struct Rect : public logging::Loggable {
   Rect& operator-=(int32_t thickness);
   Rect& operator+=(int32_t thickness);
 
-  void log_self() const noexcept override { log_obj<Rect>(x, y, w, h); }
+  void log_self(logging::format::LineWriter& out) const noexcept override {
+    log_obj<Rect>(out, x, y, w, h);
+  }
 
   static constexpr const char* fmt() noexcept { return "{x=%u, y=%u, w=%u, h=%u}"; }
 
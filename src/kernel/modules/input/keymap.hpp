@@ -4,4 +4,7 @@
 
 namespace input {
 bool key_event_to_char(const hal::KeyEvent& ev, char& out) noexcept;
+
+/// Reverse of key_event_to_char, for input that arrives as text (serial terminals).
+bool char_to_key_event(char c, hal::KeyEvent& out) noexcept;
 }
@@ -127,4 +127,19 @@ bool key_event_to_char(const KeyEvent& ev, char& out) noexcept {
   return false;
 }
 
+bool char_to_key_event(char c, KeyEvent& out) noexcept {
+  if (c == '\r') c = '\n';
+
+  // Main block keys come first in KEYMAP, so digits never map to the keypad
+  for (const auto& e : KEYMAP) {
+    if (e.normal == c || e.shifted == c) {
+      const KeyMod mods = e.normal == c ? KeyMod::None : KeyMod::Shift;
+      out = KeyEvent{e.key, KeyEventType::Press, mods, 0, false};
+      return true;
+    }
+  }
+
+  return false;
+}
+
 }  // namespace input
@@ -1,17 +1,118 @@
 #pragma once
-#include <cstdarg>
 
-/// Log a C-style formatted message, that will always put a newline.
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/log_format.hpp>
+
+// Messages below this level are not compiled in at all, set by the build
+// (LOG_MIN_LEVEL). 0 = trace ... 4 = error.
+#ifndef AANOS_LOG_MIN_LEVEL
+#define AANOS_LOG_MIN_LEVEL 1
+#endif
+
+namespace logging {
+
+enum class Level : uint8_t {
+  Trace,
+  Debug,
+  Info,
+  Warn,
+  Error,
+  Off,
+};
+
+enum class Subsystem : uint8_t {
+  Kernel,
+  Boot,
+  Memory,
+  Driver,
+  Gfx,
+  Shell,
+  Sched,
+  Count,
+};
+
+inline constexpr size_t SUBSYSTEM_COUNT = static_cast<size_t>(Subsystem::Count);
+
+inline constexpr const char* level_names[] = {"trace", "debug", "info",
+                                              "warn",  "error", "off"};
+inline constexpr const char* subsystem_names[] = {"kernel", "boot",  "mem",  "drv",
+                                                  "gfx",    "shell", "sched"};
+
+static_assert(sizeof(subsystem_names) / sizeof(subsystem_names[0]) == SUBSYSTEM_COUNT);
+
+consteval bool compiled_in(Level level) {
+  return static_cast<uint8_t>(level) >= AANOS_LOG_MIN_LEVEL && level != Level::Off;
+}
+
+namespace internal {
+/// Runtime threshold per subsystem, owned by the logging backend.
+extern Level thresholds[SUBSYSTEM_COUNT];
+
+/// Token bucket per call site, keyed by the address of its format literal. False once
+/// the site used up its burst, the message is dropped and counted.
+bool admit(const char* site) noexcept;
+
+/// True if `line` equals the previous leveled line. Repeats are swallowed and summed up
+/// as "last message repeated N times" once a different line comes along.
+bool repeated(const char* line, size_t len) noexcept;
+}  // namespace internal
+
+inline bool enabled(Subsystem sys, Level level) noexcept {
+  return level >= internal::thresholds[static_cast<size_t>(sys)];
+}
+
+/// Puts the "[level subsystem] " tag of a filtered message.
+void put_tag(format::LineWriter& out, Subsystem sys, Level level) noexcept;
+
+template <typename... Args>
+void log_at(Level level, Subsystem sys, format::FormatFor<Args...> fmt,
+            const Args&... args) noexcept {
+  if (!internal::admit(fmt.source)) return;
+
+  format::LineWriter out;
+  put_tag(out, sys, level);
+  format::write(out, fmt, args...);
+  if (fmt.new_line) { out.put_char('\n'); }
+
+  if (!out.has_spilled() && internal::repeated(out.data(), out.size())) out.discard();
+}
+
+}  // namespace logging
+
+/// Log a formatted message, that will always put a newline.
 /// Cancel the automatic new line by putting an '\\' at the end of the fmt.
-/// Currently the following formats are supported:
-///   %c - char
-///   %s - cstr
-///   %d - int
-///   %i - int
-///   %u - uint
-///   %x - hex
-///   %p - ptr
-///   %o - loggable obj
-///   TODO: Rework these to variadic temptlates
-void log_msg(const char* fmt, ...);
-void log_msg(const char* fmt, va_list args);
+/// The format is checked against the arguments at compile time, see
+/// logging::format::FormatString for the supported specs.
+/// Unfiltered and never rate limited, meant for banners and output that was asked for.
+/// Everything else should go through the leveled LOG_* macros below.
+template <typename... Args>
+void log_msg(logging::format::FormatFor<Args...> fmt, const Args&... args) noexcept {
+  logging::format::LineWriter out;
+  logging::format::write(out, fmt, args...);
+  if (fmt.new_line) { out.put_char('\n'); }
+}
+
+// Leveled logging, e.g. LOG_DEBUG(Memory, "mapped %p", addr). Below the compile time
+// minimum the call is discarded, otherwise the arguments are only evaluated once the
+// subsystem's runtime threshold lets the message through.
+#define LOG_AT(level, sys, ...)                                       \
+  do {                                                                \
+    if constexpr (::logging::compiled_in(level)) {                    \
+      if (::logging::enabled(sys, level)) {                           \
+        ::logging::log_at(level, sys, __VA_ARGS__);                   \
+      }                                                               \
+    }                                                                 \
+  } while (0)
+
+#define LOG_TRACE(sys, ...) \
+  LOG_AT(::logging::Level::Trace, ::logging::Subsystem::sys, __VA_ARGS__)
+#define LOG_DEBUG(sys, ...) \
+  LOG_AT(::logging::Level::Debug, ::logging::Subsystem::sys, __VA_ARGS__)
+#define LOG_INFO(sys, ...) \
+  LOG_AT(::logging::Level::Info, ::logging::Subsystem::sys, __VA_ARGS__)
+#define LOG_WARN(sys, ...) \
+  LOG_AT(::logging::Level::Warn, ::logging::Subsystem::sys, __VA_ARGS__)
+#define LOG_ERROR(sys, ...) \
+  LOG_AT(::logging::Level::Error, ::logging::Subsystem::sys, __VA_ARGS__)
@@ -0,0 +1,324 @@
+#pragma once
+
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "math/int_format.hpp"
+
+namespace logging::format {
+
+/// Hand a finished run of output to the active log sink, provided by the backend.
+void sink_write(const char* data, size_t len) noexcept;
+
+class LineWriter;
+
+template <typename T>
+concept SelfLogging = requires(const T& t, LineWriter& out) { t.log_self(out); };
+
+// Never defined. Calling one during constant evaluation turns a bad format into a
+// compile error that names the problem.
+void format_error_unknown_spec();
+void format_error_argument_type_mismatch();
+void format_error_too_few_arguments();
+void format_error_too_many_arguments();
+void format_error_dangling_percent();
+void format_error_too_many_escapes();
+
+consteval bool is_known_spec(char spec) {
+  switch (spec) {
+    case 'c':
+    case 's':
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'b':
+    case 'p':
+    case 'o':
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// Which specs an argument of type T may be used with. Arguments are looked at after
+/// decay, so char arrays count as strings. Enums and bools are integers.
+template <typename T>
+consteval bool accepts(char spec) {
+  using D = std::decay_t<T>;
+  constexpr bool is_integer = std::is_integral_v<D> || std::is_enum_v<D>;
+  constexpr bool is_pointer = std::is_pointer_v<D> || std::is_null_pointer_v<D>;
+
+  switch (spec) {
+    case 'c':
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'x':
+    case 'b':
+      return is_integer;
+    case 's':
+      return std::is_same_v<std::remove_cv_t<std::remove_pointer_t<D>>, char> ||
+             std::is_null_pointer_v<D>;
+    case 'p':
+      return is_pointer;
+    case 'o':
+      if constexpr (std::is_pointer_v<D>) {
+        return SelfLogging<std::remove_cv_t<std::remove_pointer_t<D>>>;
+      }
+      return std::is_null_pointer_v<D>;
+    default:
+      return false;
+  }
+}
+
+/// A literal run of the format, or (spec != 0) the slot of the next argument.
+struct Piece {
+  const char* text;
+  uint16_t len;
+  char spec;
+};
+
+/// Format string checked against the argument types at compile time and pre-split into
+/// literal runs and argument slots. Supported specs:
+///   %c - char          %s - cstr           %p - ptr
+///   %d, %i - int       %u - uint           %x - hex ("0x" prefixed)
+///   %b - binary        %o - loggable obj   %% - '%'
+/// All integer specs take any integer or enum of any width. A '\' as the last character
+/// suppresses the automatic new line.
+template <typename... Args>
+class FormatString {
+ public:
+  // Every "%%" costs one extra piece since literal runs point into the original string
+  static constexpr size_t MaxEscapes = 4;
+  static constexpr size_t Capacity = 2 * sizeof...(Args) + 1 + MaxEscapes;
+
+  consteval FormatString(const char* fmt) : source(fmt) {
+    size_t arg = 0;
+    const char* lit = fmt;
+    const char* p = fmt;
+
+    while (*p) {
+      if (*p == '\\' && p[1] == '\0') {
+        add_literal(lit, p);
+        new_line = false;
+        lit = ++p;
+        break;
+      }
+
+      if (*p != '%') {
+        ++p;
+        continue;
+      }
+
+      const char spec = p[1];
+      if (spec == '\0') format_error_dangling_percent();
+
+      if (spec == '%') {
+        // Keep the first '%' in the current run, drop the second
+        add_literal(lit, p + 1);
+        p += 2;
+        lit = p;
+        continue;
+      }
+
+      if (!is_known_spec(spec)) format_error_unknown_spec();
+      if (arg >= sizeof...(Args)) format_error_too_few_arguments();
+      if (!accepts_arg(arg, spec)) format_error_argument_type_mismatch();
+
+      add_literal(lit, p);
+      add({nullptr, 0, spec});
+      ++arg;
+      p += 2;
+      lit = p;
+    }
+
+    add_literal(lit, p);
+    if (arg != sizeof...(Args)) format_error_too_many_arguments();
+  }
+
+  Piece pieces[Capacity]{};
+  size_t count{0};
+  bool new_line{true};
+  /// The literal itself, its address identifies the call site.
+  const char* source{nullptr};
+
+ private:
+  static consteval bool accepts_arg([[maybe_unused]] size_t arg,
+                                    [[maybe_unused]] char spec) {
+    size_t i = 0;
+    return ((i++ == arg && accepts<Args>(spec)) || ...);
+  }
+
+  consteval void add(Piece piece) {
+    if (count == Capacity) format_error_too_many_escapes();
+    pieces[count++] = piece;
+  }
+
+  consteval void add_literal(const char* begin, const char* end) {
+    if (end != begin) add({begin, static_cast<uint16_t>(end - begin), 0});
+  }
+};
+
+/// Lets deduction of the arguments happen before the format is checked against them.
+template <typename... Args>
+using FormatFor = FormatString<std::type_identity_t<Args>...>;
+
+/// Collects the output of one log line on the stack so the sink sees a single write per
+/// line, or per buffer full. Runs longer than the buffer go to the sink directly.
+class LineWriter {
+ public:
+  static constexpr size_t BufferSize = 128;
+
+  LineWriter() noexcept = default;
+
+  LineWriter(const LineWriter&) = delete;
+  LineWriter(LineWriter&&) = delete;
+  LineWriter& operator=(const LineWriter&) = delete;
+  LineWriter& operator=(LineWriter&&) = delete;
+
+  ~LineWriter() { flush(); }
+
+  void put_chars(const char* s, size_t n) noexcept {
+    if (len + n > BufferSize) {
+      flush();
+      spilled = true;
+      if (n > BufferSize) {
+        sink_write(s, n);
+        return;
+      }
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+      buf[len + i] = s[i];
+    }
+    len += n;
+  }
+
+  void put_char(char c) noexcept { put_chars(&c, 1); }
+
+  void put_cstr(const char* s) noexcept {
+    size_t n = 0;
+    while (s[n]) {
+      ++n;
+    }
+    put_chars(s, n);
+  }
+
+  void put_uint(uint64_t value, uint32_t base, bool uppercase) noexcept {
+    char digits[math::MAX_INT_DIGITS];
+    char* end = digits + sizeof(digits);
+    char* begin = math::format_uint(value, base, uppercase, end);
+    put_chars(begin, static_cast<size_t>(end - begin));
+  }
+
+  void put_int(int64_t value) noexcept {
+    if (value < 0) {
+      put_char('-');
+      put_uint(0 - static_cast<uint64_t>(value), 10, false);
+    } else {
+      put_uint(static_cast<uint64_t>(value), 10, false);
+    }
+  }
+
+  void flush() noexcept {
+    if (len) sink_write(buf, len);
+    len = 0;
+  }
+
+  /// What has not reached the sink yet. Everything written so far unless `spilled`.
+  const char* data() const noexcept { return buf; }
+  size_t size() const noexcept { return len; }
+  bool has_spilled() const noexcept { return spilled; }
+
+  void discard() noexcept { len = 0; }
+
+ private:
+  size_t len{0};
+  bool spilled{false};
+  char buf[BufferSize];
+};
+
+template <typename T>
+  requires(std::is_integral_v<T> || std::is_enum_v<T>)
+void put_arg(LineWriter& out, char spec, T value) noexcept {
+  if constexpr (std::is_enum_v<T>) {
+    put_arg(out, spec, static_cast<std::underlying_type_t<T>>(value));
+  } else if constexpr (std::is_same_v<T, bool>) {
+    put_arg(out, spec, static_cast<unsigned>(value));
+  } else {
+    using U = std::make_unsigned_t<T>;
+    switch (spec) {
+      case 'c':
+        out.put_char(static_cast<char>(value));
+        break;
+      case 'd':
+      case 'i':
+        if constexpr (std::is_signed_v<T>) {
+          out.put_int(value);
+        } else {
+          out.put_uint(value, 10, false);
+        }
+        break;
+      case 'u':
+        out.put_uint(static_cast<U>(value), 10, false);
+        break;
+      case 'x':
+        out.put_chars("0x", 2);
+        out.put_uint(static_cast<U>(value), 16, true);
+        break;
+      case 'b':
+        out.put_chars("0b", 2);
+        out.put_uint(static_cast<U>(value), 2, true);
+        break;
+    }
+  }
+}
+
+template <typename T>
+void put_arg(LineWriter& out, char spec, T* ptr) noexcept {
+  if (!ptr) {
+    out.put_chars("<null>", 6);
+    return;
+  }
+
+  if constexpr (std::is_same_v<std::remove_cv_t<T>, char>) {
+    if (spec == 's') {
+      out.put_cstr(ptr);
+      return;
+    }
+  }
+
+  if constexpr (SelfLogging<std::remove_cv_t<T>>) {
+    if (spec == 'o') {
+      ptr->log_self(out);
+      return;
+    }
+  }
+
+  out.put_chars("0x", 2);
+  out.put_uint(reinterpret_cast<uintptr_t>(ptr), 16, false);
+}
+
+inline void put_arg(LineWriter& out, char, std::nullptr_t) noexcept {
+  out.put_chars("<null>", 6);
+}
+
+/// Write the pieces of `fmt` with `args` in their slots to `out`. The new line is up to
+/// the caller.
+template <typename Fmt, typename... Args>
+void write(LineWriter& out, const Fmt& fmt, const Args&... args) noexcept {
+  size_t p = 0;
+  auto literals = [&] {
+    for (; p < fmt.count && !fmt.pieces[p].spec; ++p) {
+      out.put_chars(fmt.pieces[p].text, fmt.pieces[p].len);
+    }
+  };
+
+  literals();
+  ((put_arg(out, fmt.pieces[p++].spec, args), literals()), ...);
+}
+
+}  // namespace logging::format
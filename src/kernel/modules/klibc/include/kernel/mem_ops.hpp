@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace klibc {
+
+/// Table of the hot memory and string routines behind memcpy/memset and friends.
+/// The generic table is active from the first instruction on, arch code may swap in
+/// accelerated variants once it knows what the cpu supports.
+struct MemOps {
+  const char* name;
+  void* (*memcpy)(void* __restrict__ dest, const void* __restrict__ src, size_t count);
+  void* (*memset)(void* dest, int ch, size_t count);
+  void (*fill32)(uint32_t* dest, uint32_t val, size_t count);
+  size_t (*strlen)(const char* str);
+  void* (*memchr)(const void* ptr, int ch, size_t count);
+};
+
+const MemOps& generic_mem_ops() noexcept;
+const MemOps& mem_ops() noexcept;
+
+/// Entries left as nullptr fall back to the generic implementation.
+void set_mem_ops(const MemOps& ops) noexcept;
+
+/// Fill `count` 32 bit words at `dest` with `val`.
+void fill32(uint32_t* dest, uint32_t val, size_t count) noexcept;
+
+}  // namespace klibc
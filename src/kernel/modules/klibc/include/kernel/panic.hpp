@@ -3,16 +3,24 @@
 #include <source_location>
 #include <utility>
 
+#include <kernel/log.hpp>
+
 namespace internal {
-[[noreturn]] void panic_impl(const std::source_location location, const char* fmt, ...);
-}
+void panic_begin() noexcept;
+[[noreturn]] void panic_end(const std::source_location location) noexcept;
+}  // namespace internal
 
 template <typename... Args>
 struct panic {
   [[noreturn]] panic(
-      const char* fmt, Args&&... args,
+      logging::format::FormatFor<Args...> fmt, Args&&... args,
       const std::source_location location = std::source_location::current()) {
-    internal::panic_impl(location, fmt, std::forward<Args>(args)...);
+    internal::panic_begin();
+    {
+      logging::format::LineWriter out;
+      logging::format::write(out, fmt, args...);
+    }
+    internal::panic_end(location);
   }
 };
 
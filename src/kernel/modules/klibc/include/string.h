@@ -15,6 +15,9 @@ void* __memmove_chk(void* __restrict__ dest, const void* __restrict__ src, size_
 size_t strlen(const char* start);
 int memcmp(const void* lhs, const void* rhs, size_t count);
 int strncmp(const char* lhs, const char* rhs, size_t count);
+void* memchr(const void* ptr, int ch, size_t count);
+void* memrchr(const void* ptr, int ch, size_t count);
+char* strchr(const char* str, int ch);
 
 #ifdef __cplusplus
 }
@@ -2,7 +2,38 @@
 #include <cstdint>
 #include <string.h>
 
-extern "C" void* memset(void* dest, int ch, size_t count) {
+#include <kernel/mem_ops.hpp>
+
+#include "sys/cdefs.hpp"
+
+namespace {
+
+// Word-at-a-time helpers. Aligned word loads never cross a page boundary, so reading
+// a few bytes past the end of a string inside the last word is harmless.
+typedef size_t __attribute__((__may_alias__)) word_t;
+
+constexpr size_t WordSize = sizeof(word_t);
+constexpr word_t LowBits = ~static_cast<word_t>(0) / 0xFF;
+constexpr word_t HighBits = LowBits * 0x80;
+
+constexpr bool has_zero(word_t v) noexcept {
+  return ((v - LowBits) & ~v & HighBits) != 0;
+}
+
+constexpr word_t splat(unsigned char c) noexcept {
+  return LowBits * c;
+}
+
+inline bool word_aligned(const void* p) noexcept {
+  return (reinterpret_cast<uintptr_t>(p) & (WordSize - 1)) == 0;
+}
+
+inline bool same_alignment(const void* a, const void* b) noexcept {
+  return ((reinterpret_cast<uintptr_t>(a) ^ reinterpret_cast<uintptr_t>(b)) &
+          (WordSize - 1)) == 0;
+}
+
+__klibc_no_builtin_loops void* generic_memset(void* dest, int ch, size_t count) {
   auto* p = static_cast<uint8_t*>(dest);
   auto v = static_cast<uint8_t>(ch);
 
@@ -13,8 +44,9 @@ extern "C" void* memset(void* dest, int ch, size_t count) {
   return dest;
 }
 
-extern "C" void* memcpy(void* __restrict__ dest, const void* __restrict__ src,
-                        size_t count) {
+__klibc_no_builtin_loops void* generic_memcpy(void* __restrict__ dest,
+                                              const void* __restrict__ src,
+                                              size_t count) {
   if (reinterpret_cast<uintptr_t>(dest) % sizeof(size_t) == 0 &&
       reinterpret_cast<uintptr_t>(src) % sizeof(size_t) == 0 &&
       count % sizeof(size_t) == 0) {
@@ -35,6 +67,95 @@ extern "C" void* memcpy(void* __restrict__ dest, const void* __restrict__ src,
   return dest;
 }
 
+__klibc_no_builtin_loops void generic_fill32(uint32_t* dest, uint32_t val, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    dest[i] = val;
+  }
+}
+
+__klibc_no_builtin_loops size_t generic_strlen(const char* str) {
+  const char* p = str;
+  for (; !word_aligned(p); ++p) {
+    if (*p == '\0') return static_cast<size_t>(p - str);
+  }
+
+  auto* w = reinterpret_cast<const word_t*>(p);
+  while (!has_zero(*w)) {
+    ++w;
+  }
+
+  for (p = reinterpret_cast<const char*>(w); *p != '\0'; ++p) {}
+  return static_cast<size_t>(p - str);
+}
+
+__klibc_no_builtin_loops void* generic_memchr(const void* ptr, int ch, size_t count) {
+  auto* p = static_cast<const unsigned char*>(ptr);
+  auto c = static_cast<unsigned char>(ch);
+
+  for (; count && !word_aligned(p); --count, ++p) {
+    if (*p == c) return const_cast<unsigned char*>(p);
+  }
+
+  const word_t pattern = splat(c);
+  auto* w = reinterpret_cast<const word_t*>(p);
+  for (; count >= WordSize && !has_zero(*w ^ pattern); count -= WordSize) {
+    ++w;
+  }
+
+  for (p = reinterpret_cast<const unsigned char*>(w); count; --count, ++p) {
+    if (*p == c) return const_cast<unsigned char*>(p);
+  }
+
+  return nullptr;
+}
+
+constexpr klibc::MemOps generic_ops{
+    .name = "generic",
+    .memcpy = &generic_memcpy,
+    .memset = &generic_memset,
+    .fill32 = &generic_fill32,
+    .strlen = &generic_strlen,
+    .memchr = &generic_memchr,
+};
+
+constinit klibc::MemOps active_ops = generic_ops;
+
+}  // namespace
+
+namespace klibc {
+
+const MemOps& generic_mem_ops() noexcept {
+  return generic_ops;
+}
+
+const MemOps& mem_ops() noexcept {
+  return active_ops;
+}
+
+void set_mem_ops(const MemOps& ops) noexcept {
+  active_ops.name = ops.name ? ops.name : generic_ops.name;
+  active_ops.memcpy = ops.memcpy ? ops.memcpy : generic_ops.memcpy;
+  active_ops.memset = ops.memset ? ops.memset : generic_ops.memset;
+  active_ops.fill32 = ops.fill32 ? ops.fill32 : generic_ops.fill32;
+  active_ops.strlen = ops.strlen ? ops.strlen : generic_ops.strlen;
+  active_ops.memchr = ops.memchr ? ops.memchr : generic_ops.memchr;
+}
+
+void fill32(uint32_t* dest, uint32_t val, size_t count) noexcept {
+  active_ops.fill32(dest, val, count);
+}
+
+}  // namespace klibc
+
+extern "C" void* memset(void* dest, int ch, size_t count) {
+  return active_ops.memset(dest, ch, count);
+}
+
+extern "C" void* memcpy(void* __restrict__ dest, const void* __restrict__ src,
+                        size_t count) {
+  return active_ops.memcpy(dest, src, count);
+}
+
 extern "C" void* memmove(void* __restrict__ dest, const void* __restrict__ src,
                          size_t count) {
   if (!dest || !src) return nullptr;
@@ -97,29 +218,110 @@ extern "C" void* __memmove_chk(void* __restrict__ dest, const void* __restrict__
 
 extern "C" size_t strlen(const char* start) {
   if (!start) return 0;
-  const char* end = start;
-  while (*end != '\0')
-    ++end;
-  return end - start;
+  return active_ops.strlen(start);
+}
+
+extern "C" void* memchr(const void* ptr, int ch, size_t count) {
+  return active_ops.memchr(ptr, ch, count);
+}
+
+extern "C" void* memrchr(const void* ptr, int ch, size_t count) {
+  auto* p = static_cast<const unsigned char*>(ptr) + count;
+  auto c = static_cast<unsigned char>(ch);
+
+  for (; count && !word_aligned(p); --count) {
+    if (*--p == c) return const_cast<unsigned char*>(p);
+  }
+
+  const word_t pattern = splat(c);
+  auto* w = reinterpret_cast<const word_t*>(p);
+  for (; count >= WordSize && !has_zero(w[-1] ^ pattern); count -= WordSize) {
+    --w;
+  }
+
+  p = reinterpret_cast<const unsigned char*>(w);
+  for (; count; --count) {
+    if (*--p == c) return const_cast<unsigned char*>(p);
+  }
+
+  return nullptr;
+}
+
+extern "C" char* strchr(const char* str, int ch) {
+  auto c = static_cast<char>(ch);
+  if (c == '\0') return const_cast<char*>(str + strlen(str));
+
+  const char* p = str;
+  for (; !word_aligned(p); ++p) {
+    if (*p == c) return const_cast<char*>(p);
+    if (*p == '\0') return nullptr;
+  }
+
+  const word_t pattern = splat(static_cast<unsigned char>(c));
+  auto* w = reinterpret_cast<const word_t*>(p);
+  while (!has_zero(*w) && !has_zero(*w ^ pattern)) {
+    ++w;
+  }
+
+  for (p = reinterpret_cast<const char*>(w);; ++p) {
+    if (*p == c) return const_cast<char*>(p);
+    if (*p == '\0') return nullptr;
+  }
 }
 
 extern "C" int memcmp(const void* lhs, const void* rhs, size_t count) {
   auto* a = static_cast<const unsigned char*>(lhs);
   auto* b = static_cast<const unsigned char*>(rhs);
 
-  for (size_t i = 0; i < count; ++i) {
-    if (a[i] != b[i]) { return (a[i] < b[i]) ? -1 : 1; }
+  // Words can only be compared if both sides reach alignment at the same time
+  if (count >= WordSize && same_alignment(a, b)) {
+    for (; count && !word_aligned(a); --count, ++a, ++b) {
+      if (*a != *b) { return (*a < *b) ? -1 : 1; }
+    }
+
+    auto* wa = reinterpret_cast<const word_t*>(a);
+    auto* wb = reinterpret_cast<const word_t*>(b);
+    for (; count >= WordSize && *wa == *wb; count -= WordSize) {
+      ++wa;
+      ++wb;
+    }
+
+    a = reinterpret_cast<const unsigned char*>(wa);
+    b = reinterpret_cast<const unsigned char*>(wb);
+  }
+
+  for (; count; --count, ++a, ++b) {
+    if (*a != *b) { return (*a < *b) ? -1 : 1; }
   }
 
   return 0;
 }
 
 extern "C" int strncmp(const char* lhs, const char* rhs, size_t count) {
-  auto* a = static_cast<const char*>(lhs);
-  auto* b = static_cast<const char*>(rhs);
+  auto* a = reinterpret_cast<const unsigned char*>(lhs);
+  auto* b = reinterpret_cast<const unsigned char*>(rhs);
 
-  for (size_t i = 0; i < count; ++i) {
-    if (a[i] != b[i]) { return (a[i] < b[i]) ? -1 : 1; }
+  if (count >= WordSize && same_alignment(a, b)) {
+    for (; count && !word_aligned(a); --count, ++a, ++b) {
+      if (*a != *b) { return (*a < *b) ? -1 : 1; }
+      if (*a == '\0') return 0;
+    }
+
+    // Stop at the first word that differs or holds the terminator
+    auto* wa = reinterpret_cast<const word_t*>(a);
+    auto* wb = reinterpret_cast<const word_t*>(b);
+    for (; count >= WordSize && *wa == *wb && !has_zero(*wa); count -= WordSize) {
+      ++wa;
+      ++wb;
+    }
+
+    a = reinterpret_cast<const unsigned char*>(wa);
+    b = reinterpret_cast<const unsigned char*>(wb);
+  }
+
+  for (; count; --count, ++a, ++b) {
+    if (*a != *b) { return (*a < *b) ? -1 : 1; }
+    if (*a == '\0') return 0;
   }
 
   return 0;
@@ -1,3 +1,8 @@
 #pragma once
 
 #define __myos_libc 1
+
+/// GCC turns plain copy/fill loops into calls to memcpy/memset at -O2. Inside the
+/// routines that implement those functions this would recurse, so opt them out.
+#define __klibc_no_builtin_loops \
+  __attribute__((optimize("no-tree-loop-distribute-patterns")))
@@ -25,6 +25,8 @@
 #include <stdarg.h>  // for va_args
 #include <stddef.h>  // for size_t
 
+#include "math/int_format.hpp"
+
 extern "C" {
 #define is_digit(c) (c >= '0' && c <= '9')
 
@@ -60,32 +62,28 @@ static void bputc(char* buf, size_t* pos, size_t max, char c) {
  */
 static void fmt_int(char* buf, size_t* len, size_t maxlen, long long num, int base,
                     int width, int flags) {
-  char nbuf[64], sign = 0;
+  char nbuf[math::MAX_INT_DIGITS], sign = 0;
   char altb[8];  // small buf for sign and #
-  unsigned long n = num;
+  unsigned long long n = num;
   int npad;          // number of pads
   char pchar = ' ';  // padding character
-  const char* digits = "0123456789ABCDEF";
-  const char* ldigits = "0123456789abcdef";
+  const char* digits;
   int i, j;
 
   if (base < 2 || base > 16) return;
-  if (flags & F_SMALL) digits = ldigits;
   if (flags & F_LEFT) flags &= ~F_ZEROPAD;
 
+  // '+' and ' ' only apply to signed conversions
   if ((flags & F_SIGNED) && num < 0) {
     n = -num;
     sign = '-';
-  } else if (flags & F_PLUS) {
+  } else if ((flags & F_SIGNED) && (flags & F_PLUS)) {
     sign = '+';
-  } else if (flags & F_SPACE)
+  } else if ((flags & F_SIGNED) && (flags & F_SPACE))
     sign = ' ';
 
-  i = 0;
-  do {
-    nbuf[i++] = digits[n % base];
-    n = n / base;
-  } while (n > 0);
+  digits = math::format_uint(n, base, !(flags & F_SMALL), nbuf + sizeof(nbuf));
+  i = nbuf + sizeof(nbuf) - digits;
 
   j = 0;
   if (sign) altb[j++] = sign;
@@ -113,8 +111,8 @@ static void fmt_int(char* buf, size_t* len, size_t maxlen, long long num, int ba
   for (j = 0; altb[j]; j++)
     bputc(buf, len, maxlen, altb[j]);
 
-  while (i-- > 0)
-    bputc(buf, len, maxlen, nbuf[i]);
+  for (j = 0; j < i; j++)
+    bputc(buf, len, maxlen, digits[j]);
 
   if (npad > 0 && (flags & F_LEFT))
     while (npad-- > 0)
@@ -294,6 +292,8 @@ int vsnprintf(char* buf, size_t size, const char* fmt, va_list ap) {
         } else if (c == 'b') {
           base = 2;
         }
+        // No 0x / 0 prefix for a zero value
+        if (num == 0) flags &= ~F_ALTERNATE;
         fmt_int(buf, &n, size, num, base, width, flags);
       } else if (c == 'p') {
         num = (long)va_arg(ap, void*);
@@ -305,8 +305,8 @@ int vsnprintf(char* buf, size_t size, const char* fmt, va_list ap) {
         if (!s) s = "(null)";
         fmt_str(buf, &n, size, s, width, flags);
       } else if (c == 'c') {
-        c = va_arg(ap, int);
-        fmt_chr(buf, &n, size, c, width, flags);
+        // Not stored in c, a '\0' argument must not end the format loop
+        fmt_chr(buf, &n, size, (char)va_arg(ap, int), width, flags);
       } else if (c == '%') {
         bputc(buf, &n, size, c);
       } else {
@@ -2,6 +2,8 @@
 
 #include <kernel/log.hpp>
 
+#include "trace/trace.hpp"
+
 namespace ui {
 
 void TextArea::put_char(char c) noexcept {
@@ -44,6 +46,7 @@ void TextArea::move_cursor(gfx::Point np) noexcept {
 }
 
 void TextArea::redraw() noexcept {
+  trace::Scope traced{trace::Event::RedrawBegin, trace::Event::RedrawEnd};
   tr.clear();  // this is really bad TODO: Don't do!
   gfx::Point draw_pos{0, 0};
 
@@ -182,18 +185,7 @@ size_t TextArea::visible_line_capacity() const noexcept {
 }
 
 size_t TextArea::count_lines() noexcept {
-  const auto n = buffer.count();
-  if (n == 0) {
-    lines = 1;
-    return lines;
-  }
-
-  size_t count = 1;
-  for (size_t i = 0; i < n; ++i) {
-    if (buffer[i] == '\n') { ++count; }
-  }
-
-  lines = count;
+  lines = 1 + buffer.count_of('\n');
   return lines;
 }
 
@@ -203,24 +195,16 @@ size_t TextArea::line_start_index(size_t line) const noexcept {
   const auto n = buffer.count();
   size_t cur = 0;
 
-  for (size_t i = 0; i < n; ++i) {
-    if (buffer[i] == '\n') {
-      ++cur;
-      if (cur == line) { return i + 1; }
-    }
+  for (size_t i = buffer.find('\n'); i < n; i = buffer.find('\n', i + 1)) {
+    ++cur;
+    if (cur == line) { return i + 1; }
   }
 
   return n;
 }
 
 size_t TextArea::line_end_index(size_t start_idx) const noexcept {
-  const auto n = buffer.count();
-
-  for (size_t i = start_idx; i < n; ++i) {
-    if (buffer[i] == '\n') return i;
-  }
-
-  return n;
+  return buffer.find('\n', start_idx);
 }
 
 size_t TextArea::line_height() const noexcept {
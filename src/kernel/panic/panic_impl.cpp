@@ -4,18 +4,19 @@
 #include <kernel/panic.hpp>
 
 #include "hal/system.hpp"
+#include "logging/logging.hpp"
 
 namespace internal {
-[[noreturn]] void panic_impl(const std::source_location location, const char* fmt, ...) {
-
+void panic_begin() noexcept {
   log_msg("\n[KERNEL PANIC] \\");
-  va_list args;
-  va_start(args, fmt);
-  log_msg(fmt, args);
-  va_end(args);
+}
+
+[[noreturn]] void panic_end(const std::source_location location) noexcept {
+  log_msg("");
   log_msg("at %s:%d in `%s`", location.file_name(), location.line(),
           location.function_name());
 
+  logging::backend::flush_final();
   hal::sys::halt();
 }
 }  // namespace internal
@@ -0,0 +1,267 @@
+#include "sched/bench.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/log.hpp>
+#include <kernel/log_format.hpp>
+
+#include "hal/cycles.hpp"
+#include "hal/interrupts.hpp"
+#include "sched/idle.hpp"
+#include "sched/sched.hpp"
+#include "sched/timer_wheel.hpp"
+
+namespace sched::bench {
+
+namespace {
+constexpr uint32_t PingPongSamples = 2000;
+constexpr uint32_t HandoffSamples = 2000;
+constexpr uint32_t WakeupSamples = 200;
+
+// Just past one wheel tick, the timer has to come back from idle for every sample
+constexpr uint64_t WakeupDelayNs = 100'000;
+
+// Thread starts and cold caches, not what the benchmark is after
+constexpr uint32_t WarmupSamples = 16;
+
+/// Shared by the threads of one benchmark. They all run on the boot cpu and only look at
+/// it between `yield`s or with interrupts off.
+struct Run {
+  uint64_t* samples{nullptr};
+  uint32_t count{0};
+  uint32_t capacity{0};
+  uint32_t skip{0};
+
+  Thread* waiter{nullptr};  // Blocked until the last worker is done
+  uint32_t live{0};
+  bool stop{false};
+
+  uint64_t handoff{0};  // Cycles at the last yield
+
+  Thread* sleeper{nullptr};
+  uint64_t fired{0};  // Cycles when the timeout went off
+  Timeout timeout{nullptr, nullptr};
+};
+
+/// False once the run has enough samples.
+bool record(Run& run, uint64_t cycles) noexcept {
+  if (run.skip) {
+    --run.skip;
+    return true;
+  }
+  if (run.count == run.capacity) return false;
+
+  run.samples[run.count++] = cycles;
+  return run.count < run.capacity;
+}
+
+void worker_done(Run& run) noexcept {
+  hal::irq::Guard guard;
+  if (--run.live == 0) wake(run.waiter);
+}
+
+/// The calling thread does not run again before the workers block or finish: they sit
+/// on the same priority and are queued behind it.
+bool start_workers(Run& run, uint32_t count, ThreadFn fn) noexcept {
+  run.waiter = current();
+  for (uint32_t i = 0; i < count; ++i) {
+    ++run.live;
+    if (!spawn("bench", fn, &run, BENCH_PRIORITY)) {
+      --run.live;
+      run.stop = true;
+      return false;
+    }
+  }
+  return true;
+}
+
+void wait_workers(Run& run) noexcept {
+  hal::irq::Guard guard;
+  while (run.live) {
+    block();
+  }
+}
+
+void ping_main(void* arg) noexcept {
+  auto& run = *static_cast<Run*>(arg);
+  while (!run.stop) {
+    const uint64_t start = hal::cpu::cycles();
+    yield();
+    if (!record(run, hal::cpu::cycles() - start)) run.stop = true;
+  }
+  worker_done(run);
+}
+
+void pong_main(void* arg) noexcept {
+  auto& run = *static_cast<Run*>(arg);
+  while (!run.stop) {
+    yield();
+  }
+  worker_done(run);
+}
+
+void handoff_main(void* arg) noexcept {
+  auto& run = *static_cast<Run*>(arg);
+  while (!run.stop) {
+    // Every thread measures the switch that brought it here. A preemption in between
+    // shows up as an outlier, that is what p99 is for
+    if (run.handoff && !record(run, hal::cpu::cycles() - run.handoff)) {
+      run.stop = true;
+      break;
+    }
+    run.handoff = hal::cpu::cycles();
+    yield();
+  }
+  worker_done(run);
+}
+
+void on_wakeup(Timeout& timeout) noexcept {
+  auto& run = *static_cast<Run*>(timeout.ctx);
+  run.fired = hal::cpu::cycles();
+  wake(run.sleeper);
+}
+
+void sleeper_main(void* arg) noexcept {
+  auto& run = *static_cast<Run*>(arg);
+  {
+    hal::irq::Guard guard;
+    run.sleeper = current();
+    while (!run.stop) {
+      add_timeout(run.timeout, now_ns() + WakeupDelayNs);
+      block();
+      if (!record(run, hal::cpu::cycles() - run.fired)) run.stop = true;
+    }
+  }
+  worker_done(run);
+}
+
+/// Shell sort, the sample arrays are small and there is no std::sort here.
+void sort(uint64_t* v, uint32_t n) noexcept {
+  for (uint32_t gap = n / 2; gap; gap /= 2) {
+    for (uint32_t i = gap; i < n; ++i) {
+      const uint64_t x = v[i];
+      uint32_t j = i;
+      for (; j >= gap && v[j - gap] > x; j -= gap) {
+        v[j] = v[j - gap];
+      }
+      v[j] = x;
+    }
+  }
+}
+
+void put_dec(logging::format::LineWriter& out, uint64_t v) noexcept {
+  out.put_char(' ');
+  out.put_uint(v, 10, false);
+}
+
+struct Driver {
+  ReportFn report;
+  void* ctx;
+  Thread* caller;
+  bool done;
+  bool ok;
+};
+
+void publish(Driver& d, const Result& r) noexcept {
+  {
+    logging::format::LineWriter out;
+    out.put_cstr("#schedbench ");
+    out.put_cstr(r.name);
+    put_dec(out, r.threads);
+    put_dec(out, r.samples);
+    put_dec(out, r.min);
+    put_dec(out, r.median);
+    put_dec(out, r.p99);
+    put_dec(out, r.max);
+    out.put_char('\n');
+  }
+  if (d.report) d.report(r, d.ctx);
+}
+
+/// Run `threads` workers, the first one `first` and the rest `rest`, until `samples`
+/// were recorded, then publish what they measured.
+bool measure(Driver& d, const char* name, uint32_t threads, uint32_t samples,
+             ThreadFn first, ThreadFn rest) noexcept {
+  Run run{};
+  run.samples = new uint64_t[samples];
+  run.capacity = samples;
+  run.skip = WarmupSamples + 2 * threads;
+  run.timeout.fn = &on_wakeup;
+  run.timeout.ctx = &run;
+
+  bool ok = start_workers(run, 1, first);
+  if (ok && threads > 1) ok = start_workers(run, threads - 1, rest);
+  wait_workers(run);
+
+  if (ok && run.count) {
+    sort(run.samples, run.count);
+    Result r{};
+    r.name = name;
+    r.threads = threads;
+    r.samples = run.count;
+    r.min = run.samples[0];
+    r.median = run.samples[run.count / 2];
+    r.p99 = run.samples[(run.count - 1) * 99 / 100];
+    r.max = run.samples[run.count - 1];
+    publish(d, r);
+  }
+
+  delete[] run.samples;
+  return ok;
+}
+
+bool run_benchmarks(Driver& d) noexcept {
+  {
+    logging::format::LineWriter out;
+    out.put_cstr("#schedbench begin");
+    put_dec(out, hal::cpu::cycles_khz());
+    out.put_char('\n');
+  }
+
+  bool ok = measure(d, "pingpong", 2, PingPongSamples, &ping_main, &pong_main);
+
+  if (timer()) {
+    ok = measure(d, "wakeup", 1, WakeupSamples, &sleeper_main, nullptr) && ok;
+  } else {
+    LOG_WARN(Sched, "No scheduler timer, skipping the wakeup benchmark");
+  }
+
+  for (uint32_t threads : scaling_threads) {
+    ok = measure(d, "handoff", threads, HandoffSamples, &handoff_main, &handoff_main) &&
+         ok;
+  }
+
+  {
+    logging::format::LineWriter out;
+    out.put_cstr("#schedbench end\n");
+  }
+  return ok;
+}
+
+void driver_main(void* arg) noexcept {
+  auto& d = *static_cast<Driver*>(arg);
+  const bool ok = run_benchmarks(d);
+
+  hal::irq::Guard guard;
+  d.ok = ok;
+  d.done = true;
+  wake(d.caller);
+}
+}  // namespace
+
+bool run_all(ReportFn report, void* ctx) noexcept {
+  if (!started()) return false;
+
+  // The workers must not preempt whoever drives them, so that is a thread of their own
+  Driver d{report, ctx, current(), false, false};
+  if (!spawn("schedbench", &driver_main, &d, BENCH_PRIORITY)) return false;
+
+  hal::irq::Guard guard;
+  while (!d.done) {
+    block();
+  }
+  return d.ok;
+}
+
+}  // namespace sched::bench
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sched::bench {
+
+/// Threads of a benchmark run above everything but the most urgent work, so the numbers
+/// show the scheduler and not whoever else wanted the cpu.
+inline constexpr uint8_t BENCH_PRIORITY = 1;
+
+/// Thread counts of the run queue scaling benchmark.
+inline constexpr uint32_t scaling_threads[] = {1, 2, 4, 8, 16, 32};
+
+/// One benchmark, all values in cycle counter ticks.
+struct Result {
+  const char* name;
+  uint32_t threads;
+  uint32_t samples;
+  uint64_t min;
+  uint64_t median;
+  uint64_t p99;
+  uint64_t max;
+};
+
+using ReportFn = void (*)(const Result& result, void* ctx);
+
+/// Measure the scheduler from its own threads:
+///   pingpong  round trip of two threads handing the cpu back and forth with `yield`
+///   wakeup    from a timeout firing in the timer interrupt to the woken thread running
+///   handoff   from one `yield` to the next thread running, with N threads ready
+/// The calling thread blocks until all of them finished. Every result goes to the log
+/// sink as one line, numbers in decimal:
+///   #schedbench begin <cycles khz>
+///   #schedbench <name> <threads> <samples> <min> <median> <p99> <max>
+///   #schedbench end
+/// and to `report` if given. The wakeup benchmark needs the scheduler's timer and is
+/// skipped without one. False if the scheduler is not up or threads could not be created.
+bool run_all(ReportFn report = nullptr, void* ctx = nullptr) noexcept;
+
+}  // namespace sched::bench
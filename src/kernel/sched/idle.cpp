@@ -0,0 +1,64 @@
+#include "sched/idle.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/cycles.hpp"
+
+namespace sched {
+
+namespace {
+struct HookEntry {
+  IdleHook hook;
+  void* ctx;
+};
+
+HookEntry hooks[MAX_IDLE_HOOKS];
+size_t hook_count{0};
+
+hal::Timer* idle_timer{nullptr};
+uint64_t idle_cycles{0};
+uint64_t halt_count{0};
+}  // namespace
+
+bool add_idle_hook(IdleHook hook, void* ctx) noexcept {
+  if (!hook || hook_count >= MAX_IDLE_HOOKS) return false;
+
+  hooks[hook_count++] = {hook, ctx};
+  return true;
+}
+
+void run_idle_hooks() noexcept {
+  for (size_t i = 0; i < hook_count; ++i) {
+    hooks[i].hook(hooks[i].ctx);
+  }
+}
+
+void set_timer(hal::Timer* timer) noexcept {
+  idle_timer = timer;
+}
+
+hal::Timer* timer() noexcept {
+  return idle_timer;
+}
+
+uint64_t now_ns() noexcept {
+  if (idle_timer) return idle_timer->now_ns();
+  return hal::cpu::cycles_to_ns(hal::cpu::cycles());
+}
+
+void halt(uint64_t deadline_ns) noexcept {
+  if (idle_timer && deadline_ns != NO_DEADLINE) idle_timer->arm_oneshot(deadline_ns);
+
+  const uint64_t start = hal::cpu::cycles();
+  hal::irq::wait();
+  idle_cycles += hal::cpu::cycles() - start;
+  ++halt_count;
+}
+
+IdleStats idle_stats() noexcept {
+  hal::irq::Guard guard;
+  return {hal::cpu::cycles_to_ns(idle_cycles), halt_count};
+}
+
+}  // namespace sched
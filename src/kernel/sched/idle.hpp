@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "hal/timer.hpp"
+
+namespace sched {
+
+using IdleHook = void (*)(void* ctx);
+
+inline constexpr size_t MAX_IDLE_HOOKS = 8;
+inline constexpr uint64_t NO_DEADLINE = UINT64_MAX;
+
+/// Register work that is deferred until the cpu has nothing better to do, like draining
+/// buffered log output. Returns false once all slots are taken.
+bool add_idle_hook(IdleHook hook, void* ctx) noexcept;
+
+/// Run every registered idle hook once. Called by loops that wait for input.
+void run_idle_hooks() noexcept;
+
+/// Clock and wakeup source for deadlines, sleeping and preemption. Without one only
+/// other interrupts end a halt.
+void set_timer(hal::Timer* timer) noexcept;
+hal::Timer* timer() noexcept;
+
+/// Nanoseconds on the timer's clock, or straight from the cycle counter without one.
+uint64_t now_ns() noexcept;
+
+/// Halt the cpu until the next interrupt, at the latest until `deadline_ns`. There is no
+/// periodic tick, the timer is armed only when a deadline asks for it. Must be called
+/// with interrupts off, returns with them on.
+void halt(uint64_t deadline_ns = NO_DEADLINE) noexcept;
+
+/// Wait for the next interrupt, at the latest until `deadline_ns`. Before the scheduler
+/// runs this is `halt`, afterwards only the calling thread waits and the others keep the
+/// cpu. Must be called with interrupts off, returns with them on.
+void wait_for_interrupt(uint64_t deadline_ns = NO_DEADLINE) noexcept;
+
+/// Run the idle hooks, then wait for the next interrupt unless `ready` reports that the
+/// awaited work is already there. `ready` runs with interrupts off, so work an interrupt
+/// delivers between the check and the wait still ends it. Only for waits that an
+/// interrupt or `deadline_ns` will end. Returns with interrupts on.
+template <typename Ready>
+void idle_wait(Ready&& ready, uint64_t deadline_ns = NO_DEADLINE) noexcept {
+  run_idle_hooks();
+
+  hal::irq::disable();
+  if (ready()) {
+    hal::irq::enable();
+    return;
+  }
+  wait_for_interrupt(deadline_ns);
+}
+
+struct IdleStats {
+  uint64_t idle_ns;
+  uint64_t halts;
+};
+
+/// Time spent halted since boot, including the interrupt handlers that ended each halt.
+IdleStats idle_stats() noexcept;
+
+}  // namespace sched
@@ -0,0 +1,449 @@
+#include "sched/sched.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/log.hpp>
+#include <kernel/panic.hpp>
+
+#include "hal/interrupts.hpp"
+#include "hal/smp.hpp"
+#include "sched/timer_wheel.hpp"
+
+namespace sched {
+
+namespace {
+
+// Written over the lowest words of every stack, gone means the thread overflowed
+constexpr uint32_t StackCanary = 0x57ACC0DEu;
+constexpr size_t CanaryWords = 4;
+
+struct RunQueue {
+  Thread* head;
+  Thread* tail;
+};
+
+hal::Cpu* cpu_ops{nullptr};
+
+Thread boot_thread{};
+Thread* idle_thread{nullptr};
+Thread* running{nullptr};
+Thread* zombie{nullptr};
+
+Thread* all_threads{nullptr};
+Thread* irq_waiters{nullptr};  // Waiting for the next interrupt, unsorted
+
+// Every deadline: sleeping threads and `add_timeout` users
+TimerWheel timeouts{};
+
+// One FIFO per priority and a bit per non-empty FIFO, picking is a find-first-set
+RunQueue queues[PRIORITY_LEVELS]{};
+uint32_t ready_mask{0};
+
+uint32_t next_id{0};
+uint64_t slice_end{0};
+bool need_resched{false};
+
+void enqueue(Thread* t) noexcept {
+  t->state = ThreadState::Ready;
+  t->next = nullptr;
+
+  auto& q = queues[t->priority];
+  if (q.tail) {
+    q.tail->next = t;
+  } else {
+    q.head = t;
+  }
+  q.tail = t;
+  ready_mask |= 1u << t->priority;
+}
+
+Thread* dequeue() noexcept {
+  if (!ready_mask) return nullptr;
+
+  const uint32_t prio = __builtin_ctz(ready_mask);
+  auto& q = queues[prio];
+  Thread* t = q.head;
+  q.head = t->next;
+  if (!q.head) {
+    q.tail = nullptr;
+    ready_mask &= ~(1u << prio);
+  }
+  t->next = nullptr;
+  return t;
+}
+
+void remove_irq_waiter(Thread* t) noexcept {
+  for (Thread** link = &irq_waiters; *link; link = &(*link)->next) {
+    if (*link == t) {
+      *link = t->next;
+      t->next = nullptr;
+      return;
+    }
+  }
+}
+
+/// Park the current thread until its deadline and/or the next interrupt.
+void add_waiter(Thread* t) noexcept {
+  if (t->waits_for_irq) {
+    t->next = irq_waiters;
+    irq_waiters = t;
+  }
+  if (t->wake_ns != NO_DEADLINE) timeouts.add(t->wakeup, t->wake_ns);
+}
+
+void remove_waiter(Thread* t) noexcept {
+  if (t->waits_for_irq) remove_irq_waiter(t);
+  timeouts.cancel(t->wakeup);
+}
+
+void wake_waiter(Thread* t) noexcept {
+  t->waits_for_irq = false;
+  t->wake_ns = NO_DEADLINE;
+  enqueue(t);
+}
+
+void on_wakeup_timeout(Timeout& timeout) noexcept {
+  auto* t = static_cast<Thread*>(timeout.ctx);
+  if (t->waits_for_irq) remove_irq_waiter(t);
+  wake_waiter(t);
+}
+
+/// Fire the timeouts that are due, which wakes sleepers whose deadline passed, and after
+/// an interrupt wake everyone waiting for one.
+void wake_waiters(uint64_t now, bool interrupted) noexcept {
+  timeouts.advance(now);
+  if (!interrupted) return;
+
+  Thread* t = irq_waiters;
+  irq_waiters = nullptr;
+  while (t) {
+    Thread* next = t->next;
+    timeouts.cancel(t->wakeup);
+    wake_waiter(t);
+    t = next;
+  }
+}
+
+/// One deadline covers everything: the next timeout and, while others want the cpu, the
+/// end of the slice.
+void arm_next_event() noexcept {
+  hal::Timer* clock = timer();
+  if (!clock) return;
+
+  uint64_t next = timeouts.next_expiry_ns();
+
+  // Interrupt waiters recheck on every timer event, keep those coming while busy
+  if (running != idle_thread && (ready_mask || irq_waiters) && slice_end < next) {
+    next = slice_end;
+  }
+  if (next != NO_DEADLINE) clock->arm_oneshot(next);
+}
+
+void check_stack(const Thread* t) noexcept {
+  if (!t->stack) return;
+
+  const auto* canary = reinterpret_cast<const uint32_t*>(t->stack);
+  for (size_t i = 0; i < CanaryWords; ++i) {
+    if (canary[i] != StackCanary) panic("Thread %s overflowed its stack", t->name);
+  }
+}
+
+void reap() noexcept {
+  if (!zombie) return;
+
+  for (Thread** link = &all_threads; *link; link = &(*link)->next_all) {
+    if (*link == zombie) {
+      *link = zombie->next_all;
+      break;
+    }
+  }
+
+  if (zombie != &boot_thread) {
+    delete[] zombie->stack;
+    delete zombie;
+  }
+  zombie = nullptr;
+}
+
+/// Pick the next thread and switch to it. The current one must already be queued,
+/// parked or dead unless it keeps running. Interrupts are off.
+void schedule() noexcept {
+  need_resched = false;
+
+  Thread* prev = running;
+  if (prev->state == ThreadState::Running) {
+    // The idle thread never queues, it is what runs when the queues are empty
+    if (prev == idle_thread) {
+      prev->state = ThreadState::Ready;
+    } else {
+      enqueue(prev);
+    }
+  }
+
+  Thread* next = dequeue();
+  if (!next) next = idle_thread;
+
+  const uint64_t now = now_ns();
+  slice_end = now + TIME_SLICE_NS;
+  next->state = ThreadState::Running;
+
+  if (next != prev) {
+    check_stack(prev);
+    prev->run_ns += now - prev->last_start_ns;
+    next->last_start_ns = now;
+    ++next->switches;
+    running = next;
+  }
+
+  arm_next_event();
+
+  if (next != prev) {
+    cpu_ops->switch_to(prev->context, next->context);
+    reap();
+  }
+}
+
+/// Inside an interrupt the exit hook acts on `need_resched`, but a thread that has them
+/// off would only get there with some unrelated interrupt, which a tickless timer may
+/// never send. Ask for one right away. A switch before it fires re-arms the real
+/// deadline, so at worst this costs one spurious timer event.
+void request_resched_interrupt() noexcept {
+  if (hal::Timer* clock = timer()) clock->arm_oneshot(now_ns());
+}
+
+bool should_preempt(uint64_t now) noexcept {
+  if (!ready_mask) return false;
+  if (running == idle_thread) return true;
+
+  const uint32_t best = __builtin_ctz(ready_mask);
+  if (best < running->priority) return true;
+  return best == running->priority && now >= slice_end;
+}
+
+/// From the timer interrupt, the switch itself waits for `preempt_on_exit`.
+void on_timer(void*) noexcept {
+  if (!running) return;
+
+  const uint64_t now = now_ns();
+  wake_waiters(now, true);
+
+  if (should_preempt(now)) {
+    need_resched = true;
+  } else {
+    arm_next_event();
+  }
+}
+
+/// Switching away at the end of an interrupt is fine: the interrupted thread keeps its
+/// interrupt frame on its own stack and irets once it runs again. Threads only run on
+/// the boot cpu, interrupts on the others must leave them alone.
+void preempt_on_exit() noexcept {
+  if (need_resched && running && hal::smp::cpu_id() == 0) schedule();
+}
+
+[[noreturn]] void thread_main(void* arg) noexcept {
+  reap();
+  hal::irq::enable();
+
+  auto* self = static_cast<Thread*>(arg);
+  self->fn(self->arg);
+  exit();
+}
+
+[[noreturn]] void idle_main(void*) noexcept {
+  for (;;) {
+    run_idle_hooks();
+
+    hal::irq::disable();
+    if (ready_mask) {
+      schedule();
+      hal::irq::enable();
+      continue;
+    }
+
+    // The timer is already armed for the next sleeper
+    halt();
+
+    hal::irq::disable();
+    wake_waiters(now_ns(), true);
+    hal::irq::enable();
+  }
+}
+
+Thread* create(const char* name, ThreadFn fn, void* arg, uint8_t priority) noexcept {
+  auto* t = new Thread{};
+  t->stack = new uint8_t[STACK_SIZE];
+  t->name = name;
+  t->fn = fn;
+  t->arg = arg;
+  t->priority = priority < PRIORITY_LEVELS ? priority : PRIORITY_LEVELS - 1;
+  t->wakeup.fn = &on_wakeup_timeout;
+  t->wakeup.ctx = t;
+
+  auto* canary = reinterpret_cast<uint32_t*>(t->stack);
+  for (size_t i = 0; i < CanaryWords; ++i) {
+    canary[i] = StackCanary;
+  }
+
+  const auto top = reinterpret_cast<uintptr_t>(t->stack + STACK_SIZE);
+  if (!cpu_ops->create_context(t->context, &thread_main, t, top)) {
+    delete[] t->stack;
+    delete t;
+    return nullptr;
+  }
+
+  hal::irq::Guard guard;
+  t->id = next_id++;
+  t->next_all = all_threads;
+  all_threads = t;
+  return t;
+}
+
+}  // namespace
+
+void init(hal::Cpu& cpu) noexcept {
+  cpu_ops = &cpu;
+
+  boot_thread.name = "main";
+  boot_thread.wakeup.fn = &on_wakeup_timeout;
+  boot_thread.wakeup.ctx = &boot_thread;
+  boot_thread.id = next_id++;
+  boot_thread.state = ThreadState::Running;
+  boot_thread.last_start_ns = now_ns();
+  all_threads = &boot_thread;
+  running = &boot_thread;
+  timeouts.reset(now_ns());
+
+  idle_thread = create("idle", &idle_main, nullptr, PRIORITY_LEVELS - 1);
+  if (!idle_thread) panic("Failed to create the idle thread");
+  idle_thread->state = ThreadState::Ready;
+
+  if (hal::Timer* clock = timer()) clock->set_handler(&on_timer, nullptr);
+  hal::irq::set_exit_hook(&preempt_on_exit);
+  LOG_INFO(Sched, "Scheduler up, %u priorities, %u ms slices", PRIORITY_LEVELS,
+           TIME_SLICE_NS / 1'000'000);
+}
+
+bool started() noexcept {
+  return running != nullptr;
+}
+
+Thread* spawn(const char* name, ThreadFn fn, void* arg, uint8_t priority) noexcept {
+  if (!started() || !fn) return nullptr;
+
+  Thread* t = create(name, fn, arg, priority);
+  if (!t) return nullptr;
+
+  hal::irq::Guard guard;
+  enqueue(t);
+  if (t->priority < running->priority) schedule();
+  return t;
+}
+
+Thread* current() noexcept {
+  return running;
+}
+
+void yield() noexcept {
+  if (!started()) return;
+
+  hal::irq::Guard guard;
+  schedule();
+}
+
+void exit() noexcept {
+  hal::irq::disable();
+  running->state = ThreadState::Dead;
+  zombie = running;
+  schedule();
+  panic("Dead thread %s was scheduled again", running->name);
+}
+
+void sleep_until(uint64_t deadline_ns) noexcept {
+  while (now_ns() < deadline_ns) {
+    if (!started()) {
+      idle_wait([&] { return now_ns() >= deadline_ns; }, deadline_ns);
+      continue;
+    }
+
+    hal::irq::Guard guard;
+    running->wake_ns = deadline_ns;
+    running->state = ThreadState::Blocked;
+    add_waiter(running);
+    schedule();
+  }
+}
+
+void sleep_ms(uint32_t ms) noexcept {
+  sleep_until(now_ns() + uint64_t{ms} * 1'000'000);
+}
+
+void wait_for_interrupt(uint64_t deadline_ns) noexcept {
+  if (!started() || running == idle_thread) {
+    halt(deadline_ns);
+    return;
+  }
+
+  running->waits_for_irq = true;
+  running->wake_ns = deadline_ns;
+  running->state = ThreadState::Blocked;
+  add_waiter(running);
+  schedule();
+  hal::irq::enable();
+}
+
+void block() noexcept {
+  running->state = ThreadState::Blocked;
+  schedule();
+}
+
+void wake(Thread* thread) noexcept {
+  if (!thread) return;
+
+  const bool was_enabled = hal::irq::save_and_disable();
+  if (thread->state == ThreadState::Blocked) {
+    if (thread->waits_for_irq || thread->wake_ns != NO_DEADLINE) {
+      remove_waiter(thread);
+      thread->waits_for_irq = false;
+      thread->wake_ns = NO_DEADLINE;
+    }
+    enqueue(thread);
+
+    if (running == idle_thread || thread->priority < running->priority) {
+      need_resched = true;
+      if (was_enabled) {
+        schedule();
+      } else {
+        request_resched_interrupt();
+      }
+    }
+  }
+  hal::irq::restore(was_enabled);
+}
+
+void add_timeout(Timeout& timeout, uint64_t deadline_ns) noexcept {
+  hal::irq::Guard guard;
+  timeouts.add(timeout, deadline_ns);
+  arm_next_event();
+}
+
+bool cancel_timeout(Timeout& timeout) noexcept {
+  hal::irq::Guard guard;
+  // An earlier wakeup left armed only costs a spurious timer event
+  return timeouts.cancel(timeout);
+}
+
+TimeoutStats timeout_stats() noexcept {
+  hal::irq::Guard guard;
+  return {timeouts.stats(), timeouts.pending()};
+}
+
+void for_each_thread(void (*fn)(const Thread& thread, void* ctx), void* ctx) noexcept {
+  hal::irq::Guard guard;
+  for (const Thread* t = all_threads; t; t = t->next_all) {
+    fn(*t, ctx);
+  }
+}
+
+}  // namespace sched
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/cpu.hpp"
+#include "sched/idle.hpp"
+#include "sched/timer_wheel.hpp"
+
+namespace sched {
+
+using ThreadFn = void (*)(void* arg);
+
+/// 0 is the most urgent. A thread only runs while no higher level has one ready, threads
+/// on the same level take turns every TIME_SLICE_NS.
+inline constexpr size_t PRIORITY_LEVELS = 8;
+inline constexpr uint8_t DEFAULT_PRIORITY = 4;
+
+inline constexpr size_t STACK_SIZE = 16 * 1024;
+inline constexpr uint64_t TIME_SLICE_NS = 10'000'000;
+
+enum class ThreadState : uint8_t {
+  Ready,
+  Running,
+  Blocked,
+  Dead,
+};
+
+inline constexpr const char* thread_state_names[] = {"ready", "running", "blocked",
+                                                     "dead"};
+
+struct Thread {
+  hal::CpuContext context{};
+  Thread* next{nullptr};  // Run queue or wait list
+  Thread* next_all{nullptr};
+
+  const char* name{nullptr};
+  uint32_t id{0};
+  uint8_t priority{DEFAULT_PRIORITY};
+  ThreadState state{ThreadState::Ready};
+
+  bool waits_for_irq{false};
+  uint64_t wake_ns{NO_DEADLINE};
+  Timeout wakeup{nullptr, nullptr};  // Armed for wake_ns while blocked
+
+  ThreadFn fn{nullptr};
+  void* arg{nullptr};
+  uint8_t* stack{nullptr};  // nullptr for the boot thread, its stack is not ours
+
+  uint64_t switches{0};
+  uint64_t run_ns{0};
+  uint64_t last_start_ns{0};
+};
+
+/// Turn the running boot flow into the first thread and start the idle thread. The
+/// timer from `set_timer` drives preemption and sleeping, without one threads only
+/// switch when they block or yield. Threads run on the boot cpu only, none of the calls
+/// here may be made from other cpus.
+void init(hal::Cpu& cpu) noexcept;
+
+/// True once `init` ran.
+bool started() noexcept;
+
+/// Create a thread with its own stack. It becomes ready right away.
+Thread* spawn(const char* name, ThreadFn fn, void* arg,
+              uint8_t priority = DEFAULT_PRIORITY) noexcept;
+
+Thread* current() noexcept;
+
+/// Let the other ready threads of the same priority run first.
+void yield() noexcept;
+
+/// End the current thread, its stack is freed by whoever runs next.
+[[noreturn]] void exit() noexcept;
+
+void sleep_until(uint64_t deadline_ns) noexcept;
+void sleep_ms(uint32_t ms) noexcept;
+
+/// Take the current thread off the cpu until someone calls `wake` for it. Call with
+/// interrupts off, they are off again on return.
+void block() noexcept;
+
+/// Make a blocked thread ready again. Fine from interrupt handlers.
+void wake(Thread* thread) noexcept;
+
+/// Call `timeout.fn` once the scheduler clock reaches `deadline_ns`, re-arming it if it
+/// is pending. The callback runs in the timer interrupt (or the idle thread right after
+/// a halt) with interrupts off: keep it short and queue `Work` for anything more. Safe
+/// from any context on the boot cpu. Needs `init`.
+void add_timeout(Timeout& timeout, uint64_t deadline_ns) noexcept;
+
+/// False if `timeout` already fired or was never added.
+bool cancel_timeout(Timeout& timeout) noexcept;
+
+struct TimeoutStats {
+  TimerWheel::Stats wheel;
+  size_t pending;
+};
+TimeoutStats timeout_stats() noexcept;
+
+/// Call `fn` for every live thread with interrupts off, keep it short.
+void for_each_thread(void (*fn)(const Thread& thread, void* ctx), void* ctx) noexcept;
+
+}  // namespace sched
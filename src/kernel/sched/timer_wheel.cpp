@@ -0,0 +1,182 @@
+#include "sched/timer_wheel.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sched {
+
+namespace {
+constexpr uint64_t NoDeadline = UINT64_MAX;
+
+uint64_t rotate_right(uint64_t bits, uint32_t n) noexcept {
+  n &= 63;
+  return n ? (bits >> n) | (bits << (64 - n)) : bits;
+}
+
+/// Slots from `from` to the first occupied one, 0 if `from` itself is. `occupied` must
+/// not be 0. Two 32-bit halves, i386 has no 64-bit bit scan.
+uint32_t distance(uint64_t occupied, uint32_t from) noexcept {
+  const uint64_t bits = rotate_right(occupied, from);
+  const auto low = static_cast<uint32_t>(bits);
+  if (low) return static_cast<uint32_t>(__builtin_ctz(low));
+  return 32 + static_cast<uint32_t>(__builtin_ctz(static_cast<uint32_t>(bits >> 32)));
+}
+}  // namespace
+
+void TimerWheel::reset(uint64_t now_ns) noexcept {
+  if (!count) current = now_ns >> TICK_SHIFT;
+}
+
+void TimerWheel::place(Timeout& timeout) noexcept {
+  uint64_t tick = timeout.deadline_ns >> TICK_SHIFT;
+  if (tick < current) tick = current;
+  if (tick - current >= MAX_TICKS) tick = current + MAX_TICKS - 1;
+
+  const uint64_t delta = tick - current;
+  uint32_t level = 0;
+  while (level + 1 < LEVELS && delta >= (uint64_t{1} << (SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  const auto slot = static_cast<uint32_t>(tick >> (SLOT_BITS * level)) & SlotMask;
+
+  Timeout*& head = slots[level][slot];
+  timeout.next = head;
+  if (head) head->pprev = &timeout.next;
+  head = &timeout;
+  timeout.pprev = &head;
+  timeout.level = static_cast<uint8_t>(level);
+  timeout.slot = static_cast<uint8_t>(slot);
+  occupied[level] |= uint64_t{1} << slot;
+}
+
+void TimerWheel::unlink(Timeout& timeout) noexcept {
+  *timeout.pprev = timeout.next;
+  if (timeout.next) timeout.next->pprev = timeout.pprev;
+  if (!slots[timeout.level][timeout.slot]) {
+    occupied[timeout.level] &= ~(uint64_t{1} << timeout.slot);
+  }
+  timeout.next = nullptr;
+  timeout.pprev = nullptr;
+}
+
+void TimerWheel::add(Timeout& timeout, uint64_t deadline_ns) noexcept {
+  if (timeout.pending()) {
+    unlink(timeout);
+  } else {
+    ++count;
+  }
+  timeout.deadline_ns = deadline_ns;
+  place(timeout);
+  ++totals.added;
+}
+
+bool TimerWheel::cancel(Timeout& timeout) noexcept {
+  if (!timeout.pending()) return false;
+
+  unlink(timeout);
+  --count;
+  ++totals.cancelled;
+  return true;
+}
+
+void TimerWheel::cascade(uint32_t level) noexcept {
+  const auto slot = static_cast<uint32_t>(current >> (SLOT_BITS * level)) & SlotMask;
+  Timeout* list = slots[level][slot];
+  slots[level][slot] = nullptr;
+  occupied[level] &= ~(uint64_t{1} << slot);
+
+  while (list) {
+    Timeout* t = list;
+    list = t->next;
+    place(*t);
+    ++totals.cascaded;
+  }
+}
+
+uint32_t TimerWheel::expire_current(uint64_t now_ns) noexcept {
+  Timeout** const head = &slots[0][current & SlotMask];
+  uint32_t fired = 0;
+
+  Timeout** link = head;
+  while (*link) {
+    Timeout* t = *link;
+    if (t->deadline_ns > now_ns) {
+      link = &t->next;
+      continue;
+    }
+
+    unlink(*t);
+    --count;
+    ++totals.expired;
+    ++fired;
+    t->fn(*t);
+    // The callback may have changed this very slot
+    link = head;
+  }
+  return fired;
+}
+
+uint64_t TimerWheel::next_tick(uint64_t target) const noexcept {
+  uint64_t next = target;
+
+  if (occupied[0]) {
+    const auto idx = static_cast<uint32_t>(current) & SlotMask;
+    const uint64_t tick = current + 1 + distance(occupied[0], idx + 1);
+    if (tick < next) next = tick;
+  }
+
+  // Empty levels have nothing to cascade, only the first occupied one sets a stop
+  for (uint32_t level = 1; level < LEVELS; ++level) {
+    if (!occupied[level]) continue;
+    const uint64_t span = uint64_t{1} << (SLOT_BITS * level);
+    const uint64_t boundary = (current | (span - 1)) + 1;
+    if (boundary < next) next = boundary;
+    break;
+  }
+  return next;
+}
+
+uint32_t TimerWheel::advance(uint64_t now_ns) noexcept {
+  const uint64_t target = now_ns >> TICK_SHIFT;
+  uint32_t fired = 0;
+
+  for (;;) {
+    fired += expire_current(now_ns);
+    if (current >= target) break;
+
+    current = next_tick(target);
+    for (uint32_t level = LEVELS - 1; level > 0; --level) {
+      const uint64_t span = uint64_t{1} << (SLOT_BITS * level);
+      if ((current & (span - 1)) == 0) cascade(level);
+    }
+  }
+  return fired;
+}
+
+uint64_t TimerWheel::next_expiry_ns() const noexcept {
+  if (!count) return NoDeadline;
+
+  uint64_t best = NoDeadline;
+  if (occupied[0]) {
+    const auto idx = static_cast<uint32_t>(current) & SlotMask;
+    const uint32_t slot = (idx + distance(occupied[0], idx)) & SlotMask;
+    for (const Timeout* t = slots[0][slot]; t; t = t->next) {
+      if (t->deadline_ns < best) best = t->deadline_ns;
+    }
+  }
+
+  for (uint32_t level = 1; level < LEVELS; ++level) {
+    if (!occupied[level]) continue;
+    const uint32_t shift = SLOT_BITS * level;
+    const uint64_t window = current >> shift;
+    const auto idx = static_cast<uint32_t>(window) & SlotMask;
+    // The current window's slot was already cascaded, it holds the next round
+    const uint64_t cascade_tick = (window + 1 + distance(occupied[level], idx + 1))
+                                  << shift;
+    const uint64_t ns = cascade_tick << TICK_SHIFT;
+    if (ns < best) best = ns;
+  }
+  return best;
+}
+
+}  // namespace sched
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace sched {
+
+/// A callback due at a point on the scheduler clock, embedded in whatever owns it.
+struct Timeout {
+  using Fn = void (*)(Timeout& timeout);
+
+  constexpr Timeout(Fn fn, void* ctx) noexcept : fn(fn), ctx(ctx) {}
+
+  Timeout(const Timeout&) = delete;
+  Timeout& operator=(const Timeout&) = delete;
+
+  bool pending() const noexcept { return pprev != nullptr; }
+
+  Fn fn;
+  void* ctx;
+  uint64_t deadline_ns{0};
+
+  // Owned by the wheel while pending
+  Timeout* next{nullptr};
+  Timeout** pprev{nullptr};
+  uint8_t level{0};
+  uint8_t slot{0};
+};
+
+/// Hierarchical timing wheel (Varghese & Lauck): LEVELS rings of SLOTS buckets, each
+/// level SLOTS times coarser than the one below. Adding and cancelling a timeout is O(1)
+/// however many are pending; a timeout sits in the finest level that covers its
+/// distance and moves down ("cascades") when its bucket comes up. Expiry stays exact to
+/// the nanosecond, ticks only decide the bucket. Not locked, the owner serializes calls.
+class TimerWheel {
+ public:
+  static constexpr uint32_t TICK_SHIFT = 16;  // 65.5 us per tick
+  static constexpr uint32_t SLOT_BITS = 6;
+  static constexpr uint32_t SLOTS = 1u << SLOT_BITS;
+  static constexpr uint32_t LEVELS = 4;
+  /// Timeouts further out than this many ticks (about 18 minutes) wait in the top level
+  /// and cascade again until they are in range.
+  static constexpr uint64_t MAX_TICKS = uint64_t{1} << (SLOT_BITS * LEVELS);
+
+  struct Stats {
+    uint64_t added;
+    uint64_t expired;
+    uint64_t cancelled;
+    uint64_t cascaded;  // Times a timeout moved to a finer level
+  };
+
+  constexpr TimerWheel() noexcept = default;
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /// Start counting from `now_ns`, only while nothing is pending.
+  void reset(uint64_t now_ns) noexcept;
+
+  /// Arm `timeout` for `deadline_ns`, re-arming it if it is pending. Deadlines in the
+  /// past fire on the next `advance`.
+  void add(Timeout& timeout, uint64_t deadline_ns) noexcept;
+
+  /// False if `timeout` was not pending (never added, or already fired).
+  bool cancel(Timeout& timeout) noexcept;
+
+  /// Fire everything due at `now_ns`, oldest bucket first. Callbacks may add and cancel
+  /// timeouts, including their own. Returns how many fired.
+  uint32_t advance(uint64_t now_ns) noexcept;
+
+  /// Deadline to wake up for: exact for the next timeout of the finest level, the
+  /// cascade point for coarser ones. NO_DEADLINE (UINT64_MAX) when nothing is pending.
+  uint64_t next_expiry_ns() const noexcept;
+
+  size_t pending() const noexcept { return count; }
+  const Stats& stats() const noexcept { return totals; }
+
+ private:
+  static constexpr uint32_t SlotMask = SLOTS - 1;
+
+  void place(Timeout& timeout) noexcept;
+  void unlink(Timeout& timeout) noexcept;
+  void cascade(uint32_t level) noexcept;
+  uint32_t expire_current(uint64_t now_ns) noexcept;
+  uint64_t next_tick(uint64_t target) const noexcept;
+
+  Timeout* slots[LEVELS][SLOTS]{};
+  uint64_t occupied[LEVELS]{};  // Bit per non-empty slot
+  uint64_t current{0};          // First tick not completely expired yet
+  size_t count{0};
+  Stats totals{};
+};
+
+}  // namespace sched
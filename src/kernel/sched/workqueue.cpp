@@ -0,0 +1,125 @@
+#include "sched/workqueue.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+
+namespace sched {
+
+namespace {
+constexpr uint8_t SystemQueuePriority = 2;
+
+WorkQueue system_wq{"events", SystemQueuePriority};
+
+const WorkQueue* registry[MAX_WORK_QUEUES]{};
+size_t registry_count{0};
+
+size_t wait_bucket(uint64_t wait_ns) noexcept {
+  const uint64_t us = wait_ns / 1000;
+  const size_t bucket = us ? 64 - __builtin_clzll(us) : 0;
+  return bucket < WorkQueue::HISTOGRAM_BUCKETS ? bucket
+                                               : WorkQueue::HISTOGRAM_BUCKETS - 1;
+}
+}  // namespace
+
+bool WorkQueue::start() noexcept {
+  if (worker) return true;
+
+  worker = spawn(queue_name, &worker_main, this, priority);
+  if (!worker) return false;
+
+  hal::irq::Guard guard;
+  if (registry_count < MAX_WORK_QUEUES) registry[registry_count++] = this;
+  return true;
+}
+
+bool WorkQueue::queue(Work& work) noexcept {
+  if (work.pending.exchange(true, std::memory_order_acq_rel)) {
+    coalesced.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  work.queued_ns = now_ns();
+  Work* old = head.load(std::memory_order_relaxed);
+  do {
+    work.next = old;
+  } while (!head.compare_exchange_weak(old, &work, std::memory_order_release,
+                                       std::memory_order_relaxed));
+
+  if (worker) wake(worker);
+  return true;
+}
+
+void WorkQueue::run_pending() noexcept {
+  Work* stack = head.exchange(nullptr, std::memory_order_acquire);
+
+  // Pushed newest first, run oldest first
+  Work* list = nullptr;
+  while (stack) {
+    Work* next = stack->next;
+    stack->next = list;
+    list = stack;
+    stack = next;
+  }
+
+  while (list) {
+    Work* work = list;
+    list = work->next;
+
+    const uint64_t start = now_ns();
+    const uint64_t wait = start - work->queued_ns;
+    // Cleared before the run, so work queued while it runs runs again
+    work->pending.store(false, std::memory_order_release);
+    work->fn(*work);
+    account(wait, now_ns() - start);
+  }
+}
+
+void WorkQueue::account(uint64_t wait_ns, uint64_t run_ns) noexcept {
+  hal::irq::Guard guard;
+  ++totals.runs;
+  totals.wait_total_ns += wait_ns;
+  if (wait_ns > totals.wait_max_ns) totals.wait_max_ns = wait_ns;
+  if (run_ns > totals.run_max_ns) totals.run_max_ns = run_ns;
+  ++totals.wait_histogram[wait_bucket(wait_ns)];
+}
+
+WorkQueue::Stats WorkQueue::stats() const noexcept {
+  hal::irq::Guard guard;
+  Stats copy = totals;
+  copy.coalesced = coalesced.load(std::memory_order_relaxed);
+  return copy;
+}
+
+void WorkQueue::worker_main(void* arg) noexcept {
+  auto* self = static_cast<WorkQueue*>(arg);
+  for (;;) {
+    self->run_pending();
+
+    // A queue between the check and the block is impossible with interrupts off, and
+    // `wake` after the block finds the worker blocked
+    hal::irq::disable();
+    if (!self->head.load(std::memory_order_acquire)) block();
+    hal::irq::enable();
+  }
+}
+
+WorkQueue& system_queue() noexcept {
+  return system_wq;
+}
+
+void init_work_queues() noexcept {
+  system_wq.start();
+}
+
+size_t work_queue_count() noexcept {
+  return registry_count;
+}
+
+const WorkQueue* work_queue(size_t index) noexcept {
+  return index < registry_count ? registry[index] : nullptr;
+}
+
+}  // namespace sched
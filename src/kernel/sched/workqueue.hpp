@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "sched/sched.hpp"
+
+namespace sched {
+
+/// A piece of deferred work, embedded in whatever owns it. Queueing it again while it is
+/// still pending does nothing, so a burst of interrupts costs one run.
+struct Work {
+  using Fn = void (*)(Work& work);
+
+  constexpr explicit Work(Fn fn) noexcept : fn(fn) {}
+
+  Work(const Work&) = delete;
+  Work& operator=(const Work&) = delete;
+
+  Fn fn;
+  Work* next{nullptr};
+  std::atomic<bool> pending{false};
+  uint64_t queued_ns{0};
+};
+
+/// Runs work items on a dedicated kernel thread, so interrupt handlers only do the part
+/// that cannot wait and queue the rest. `queue` is lock-free and safe from interrupt
+/// handlers: producers push onto an intrusive stack with one CAS, the worker takes the
+/// whole stack with one exchange and runs it oldest first.
+class WorkQueue {
+ public:
+  /// Wait latency histogram, bucket n counts waits below 2^n microseconds.
+  static constexpr size_t HISTOGRAM_BUCKETS = 16;
+
+  struct Stats {
+    uint64_t runs;
+    uint64_t coalesced;
+    uint64_t wait_total_ns;
+    uint64_t wait_max_ns;
+    uint64_t run_max_ns;
+    uint32_t wait_histogram[HISTOGRAM_BUCKETS];
+  };
+
+  constexpr WorkQueue(const char* name, uint8_t priority) noexcept
+      : queue_name(name), priority(priority) {}
+
+  WorkQueue(const WorkQueue&) = delete;
+  WorkQueue& operator=(const WorkQueue&) = delete;
+
+  /// Spawn the worker thread. Work queued before runs right after.
+  bool start() noexcept;
+
+  /// False if `work` was still pending, it then runs once for both requests. Must not be
+  /// called from inside the scheduler.
+  bool queue(Work& work) noexcept;
+
+  const char* name() const noexcept { return queue_name; }
+  Stats stats() const noexcept;
+
+ private:
+  static void worker_main(void* arg) noexcept;
+  void run_pending() noexcept;
+  void account(uint64_t wait_ns, uint64_t run_ns) noexcept;
+
+  const char* queue_name;
+  uint8_t priority;
+  Thread* worker{nullptr};
+
+  std::atomic<Work*> head{nullptr};
+  std::atomic<uint32_t> coalesced{0};
+  Stats totals{};
+};
+
+inline constexpr size_t MAX_WORK_QUEUES = 8;
+
+/// Shared queue for short work deferred out of interrupt handlers, ahead of normal
+/// threads. Started by `init_work_queues`.
+WorkQueue& system_queue() noexcept;
+
+/// Start the system queue. Needs a running scheduler.
+void init_work_queues() noexcept;
+
+/// Every started queue, for statistics.
+size_t work_queue_count() noexcept;
+const WorkQueue* work_queue(size_t index) noexcept;
+
+}  // namespace sched
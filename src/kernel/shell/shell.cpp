@@ -4,8 +4,24 @@
 #include <cstring>
 #include <string_view>
 
+#include <kernel/log.hpp>
+
+#include "async/executor.hpp"
+#include "async/frame_pool.hpp"
+#include "async/task.hpp"
+#include "hal/cycles.hpp"
+#include "hal/smp.hpp"
 #include "hal/system.hpp"
 #include "containers/string.hpp"
+#include "logging/logging.hpp"
+#include "math/int_format.hpp"
+#include "memory/magazine.hpp"
+#include "sched/bench.hpp"
+#include "sched/idle.hpp"
+#include "sched/sched.hpp"
+#include "sched/workqueue.hpp"
+#include "sync/lock_stats.hpp"
+#include "trace/trace.hpp"
 #include "tty/tty.hpp"
 
 namespace shell {
@@ -54,6 +70,445 @@ int cmd_sys(CommandContext& ctx) noexcept {
   return 1;
 }
 
+void write_uint(tty::Tty& tty, uint64_t value) noexcept {
+  char buf[math::MAX_INT_DIGITS];
+  char* end = buf + sizeof(buf);
+  char* begin = math::format_uint(value, 10, false, end);
+  tty.write(std::string_view{begin, static_cast<size_t>(end - begin)});
+}
+
+bool parse_uint(std::string_view str, uint32_t& out) noexcept {
+  if (str.empty() || str.size() > 9) return false;
+  uint32_t value = 0;
+  for (char c : str) {
+    if (c < '0' || c > '9') return false;
+    value = value * 10 + static_cast<uint32_t>(c - '0');
+  }
+  out = value;
+  return true;
+}
+
+int cmd_trace(CommandContext& ctx) noexcept {
+  const std::string_view opt = ctx.argc == 2 ? ctx.argv[1] : std::string_view{"status"};
+
+  if (opt == "start") {
+    trace::start();
+  } else if (opt == "stop") {
+    trace::stop();
+  } else if (opt == "clear") {
+    trace::clear();
+  } else if (opt == "mark") {
+    trace::emit(trace::Event::Mark);
+  } else if (opt == "dump") {
+    ctx.tty.write_line("Dumping trace to serial...");
+    trace::dump();
+  } else if (opt != "status") {
+    ctx.tty.write(std::string_view{"Unknown option: "});
+    ctx.tty.write_line(opt);
+    return 1;
+  }
+
+  ctx.tty.write(std::string_view{trace::running() ? "Tracing, " : "Stopped, "});
+  write_uint(ctx.tty, trace::recorded());
+  ctx.tty.write(std::string_view{" records held, "});
+  write_uint(ctx.tty, trace::overwritten());
+  ctx.tty.write_line(" overwritten");
+  return 0;
+}
+
+int cmd_uptime(CommandContext& ctx) noexcept {
+  const uint64_t up_ms = hal::cpu::cycles_to_ns(hal::cpu::cycles()) / 1'000'000;
+  const auto idle = sched::idle_stats();
+  const uint64_t idle_ms = idle.idle_ns / 1'000'000;
+
+  ctx.tty.write(std::string_view{"Up "});
+  write_uint(ctx.tty, up_ms);
+  ctx.tty.write(std::string_view{" ms, idle "});
+  write_uint(ctx.tty, idle_ms);
+  ctx.tty.write(std::string_view{" ms ("});
+  write_uint(ctx.tty, up_ms ? idle_ms * 100 / up_ms : 0);
+  ctx.tty.write(std::string_view{"%) over "});
+  write_uint(ctx.tty, idle.halts);
+  ctx.tty.write_line(" halts");
+  return 0;
+}
+
+int cmd_ps(CommandContext& ctx) noexcept {
+  struct Row {
+    const char* name;
+    uint32_t id;
+    uint8_t priority;
+    sched::ThreadState state;
+    uint64_t switches;
+    uint64_t run_ms;
+  };
+  struct Snapshot {
+    Row rows[16];
+    size_t count;
+  } snap{};
+
+  // Copy first, printing with interrupts off would stall everything else
+  sched::for_each_thread(
+      [](const sched::Thread& t, void* ctx) {
+        auto& s = *static_cast<Snapshot*>(ctx);
+        if (s.count == sizeof(s.rows) / sizeof(s.rows[0])) return;
+        s.rows[s.count++] = {t.name, t.id, t.priority, t.state, t.switches,
+                             t.run_ns / 1'000'000};
+      },
+      &snap);
+
+  ctx.tty.write_line("ID  PRIO  STATE    SWITCHES  RUN MS  NAME");
+  for (size_t i = 0; i < snap.count; ++i) {
+    const auto& r = snap.rows[i];
+    write_uint(ctx.tty, r.id);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, r.priority);
+    ctx.tty.write(std::string_view{"  "});
+    ctx.tty.write(
+        std::string_view{sched::thread_state_names[static_cast<size_t>(r.state)]});
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, r.switches);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, r.run_ms);
+    ctx.tty.write(std::string_view{"  "});
+    ctx.tty.write_line(r.name);
+  }
+  return 0;
+}
+
+int cmd_wq(CommandContext& ctx) noexcept {
+  for (size_t i = 0; i < sched::work_queue_count(); ++i) {
+    const auto* wq = sched::work_queue(i);
+    const auto st = wq->stats();
+
+    ctx.tty.write(std::string_view{wq->name()});
+    ctx.tty.write(std::string_view{": "});
+    write_uint(ctx.tty, st.runs);
+    ctx.tty.write(std::string_view{" runs, "});
+    write_uint(ctx.tty, st.coalesced);
+    ctx.tty.write(std::string_view{" coalesced, wait avg "});
+    write_uint(ctx.tty, st.runs ? st.wait_total_ns / st.runs / 1000 : 0);
+    ctx.tty.write(std::string_view{" us max "});
+    write_uint(ctx.tty, st.wait_max_ns / 1000);
+    ctx.tty.write(std::string_view{" us, run max "});
+    write_uint(ctx.tty, st.run_max_ns / 1000);
+    ctx.tty.write_line(" us");
+
+    ctx.tty.write(std::string_view{"  wait < 2^n us:"});
+    for (size_t b = 0; b < sched::WorkQueue::HISTOGRAM_BUCKETS; ++b) {
+      ctx.tty.write_char(' ');
+      write_uint(ctx.tty, st.wait_histogram[b]);
+    }
+    ctx.tty.write_char('\n');
+  }
+  return 0;
+}
+
+int cmd_cpus(CommandContext& ctx) noexcept {
+  write_uint(ctx.tty, hal::smp::cpu_count());
+  ctx.tty.write_line(" cpus online");
+
+  for (uint32_t cpu = 0; cpu < hal::smp::MAX_CPUS; ++cpu) {
+    uint32_t answered = 0;
+    const uint64_t start = hal::cpu::cycles();
+    const bool online = hal::smp::call_on(
+        cpu, [](void* arg) { *static_cast<uint32_t*>(arg) = hal::smp::cpu_id(); },
+        &answered);
+    if (!online) continue;
+    const uint64_t ns = hal::cpu::cycles_to_ns(hal::cpu::cycles() - start);
+
+    ctx.tty.write(std::string_view{"cpu "});
+    write_uint(ctx.tty, cpu);
+    ctx.tty.write(std::string_view{": answered as cpu "});
+    write_uint(ctx.tty, answered);
+    ctx.tty.write(std::string_view{" after "});
+    write_uint(ctx.tty, ns);
+    ctx.tty.write_line(" ns");
+  }
+  return 0;
+}
+
+int cmd_heap(CommandContext& ctx) noexcept {
+  ctx.tty.write_line("SIZE  HITS  DEPOT SWAPS  HEAP ALLOCS  HEAP FREES");
+  for (size_t cls = 0; cls < mem::magazine::CLASS_COUNT; ++cls) {
+    const auto st = mem::magazine::stats(cls);
+    write_uint(ctx.tty, mem::magazine::class_sizes[cls]);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, st.hits);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, st.depot_swaps);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, st.heap_allocs);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, st.heap_frees);
+    ctx.tty.write_char('\n');
+  }
+  return 0;
+}
+
+int cmd_locks(CommandContext& ctx) noexcept {
+  ctx.tty.write_line("NAME  ACQUIRED  SHARED  CONTENDED  SPINS  MAX HOLD");
+  sync::for_each_lock(
+      [](const sync::LockStats& st, void* arg) {
+        auto& tty = static_cast<CommandContext*>(arg)->tty;
+        tty.write(std::string_view{st.name});
+        tty.write(std::string_view{"  "});
+        write_uint(tty, st.acquisitions);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, st.shared_acquisitions.load(std::memory_order_relaxed));
+        tty.write(std::string_view{"  "});
+        write_uint(tty, st.contended);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, st.spins);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, st.max_hold_cycles);
+        tty.write(std::string_view{" cycles ("});
+        write_uint(tty, hal::cpu::cycles_to_ns(st.max_hold_cycles));
+        tty.write_line(" ns)");
+      },
+      &ctx);
+  return 0;
+}
+
+async::Task<> tick_task(uint32_t count, uint32_t interval_ms) {
+  const uint64_t start = sched::now_ns();
+  for (uint32_t i = 1; i <= count; ++i) {
+    co_await async::sleep_ms(interval_ms);
+    LOG_INFO(Shell, "async tick %u/%u after %u ms", i, count,
+             static_cast<uint32_t>((sched::now_ns() - start) / 1'000'000));
+  }
+}
+
+int cmd_async(CommandContext& ctx) noexcept {
+  if (ctx.argc >= 2 && ctx.argv[1] == "tick") {
+    uint32_t count = 5;
+    uint32_t interval_ms = 100;
+    if ((ctx.argc >= 3 && !parse_uint(ctx.argv[2], count)) ||
+        (ctx.argc >= 4 && !parse_uint(ctx.argv[3], interval_ms))) {
+      ctx.tty.write_line("Usage: async tick [COUNT] [INTERVAL_MS]");
+      return 1;
+    }
+    async::executor().spawn(tick_task(count, interval_ms));
+    ctx.tty.write_line("Spawned, ticks go to the log");
+    return 0;
+  }
+  if (ctx.argc >= 2) {
+    ctx.tty.write(std::string_view{"Unknown option: "});
+    ctx.tty.write_line(ctx.argv[1]);
+    return 1;
+  }
+
+  const auto st = async::executor().stats();
+  ctx.tty.write(std::string_view{"Tasks: "});
+  write_uint(ctx.tty, st.spawned);
+  ctx.tty.write(std::string_view{" spawned, "});
+  write_uint(ctx.tty, st.finished);
+  ctx.tty.write(std::string_view{" finished, "});
+  write_uint(ctx.tty, st.sleepers);
+  ctx.tty.write(std::string_view{" sleeping, "});
+  write_uint(ctx.tty, st.pollers);
+  ctx.tty.write_line(" polling");
+  ctx.tty.write(std::string_view{"Resumes: "});
+  write_uint(ctx.tty, st.resumes);
+  ctx.tty.write(std::string_view{", executor wakeups: "});
+  write_uint(ctx.tty, st.wakeups);
+  ctx.tty.write_char('\n');
+
+  const auto pool = async::frame_pool_stats();
+  ctx.tty.write_line("FRAME SIZE  LIVE  PEAK");
+  for (size_t cls = 0; cls < async::FRAME_CLASS_COUNT; ++cls) {
+    write_uint(ctx.tty, async::frame_class_sizes[cls]);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, pool.live[cls]);
+    ctx.tty.write(std::string_view{"  "});
+    write_uint(ctx.tty, pool.peak[cls]);
+    ctx.tty.write_char('\n');
+  }
+  ctx.tty.write(std::string_view{"Chunks: "});
+  write_uint(ctx.tty, pool.chunks);
+  ctx.tty.write(std::string_view{", large frames: "});
+  write_uint(ctx.tty, pool.large);
+  ctx.tty.write_char('\n');
+  return 0;
+}
+
+struct BenchTimeout {
+  sched::Timeout timeout{[](sched::Timeout&) {}, nullptr};
+};
+
+// 8 MiB of timeouts, a quarter of the kernel heap
+constexpr uint32_t MaxBenchTimeouts = 250'000;
+
+void write_per_op(tty::Tty& tty, const char* what, uint64_t cycles,
+                  uint64_t ops) noexcept {
+  tty.write(std::string_view{what});
+  write_uint(tty, ops ? cycles / ops : 0);
+  tty.write(std::string_view{" cycles/op ("});
+  write_uint(tty, ops ? hal::cpu::cycles_to_ns(cycles) / ops : 0);
+  tty.write_line(" ns)");
+}
+
+/// Runs on a private wheel with a made up clock, the system one keeps going.
+int bench_timer_wheel(CommandContext& ctx, uint32_t count) noexcept {
+  constexpr uint64_t Ms = 1'000'000;
+  constexpr uint64_t Span = 10'000 * Ms;
+
+  auto* timeouts = new BenchTimeout[count];
+  static sched::TimerWheel wheel;
+  wheel.reset(0);
+
+  // Deadlines spread over 10 s, the spread a busy system's timeouts would have
+  uint32_t seed = 0x9E3779B9u;
+  const uint64_t add_start = hal::cpu::cycles();
+  for (uint32_t i = 0; i < count; ++i) {
+    seed = seed * 1664525u + 1013904223u;
+    wheel.add(timeouts[i].timeout, Ms + (uint64_t{seed} * (Span / 4096)) / (1u << 20));
+  }
+  const uint64_t add_cycles = hal::cpu::cycles() - add_start;
+
+  const uint64_t next_start = hal::cpu::cycles();
+  volatile uint64_t sink = wheel.next_expiry_ns();
+  const uint64_t next_cycles = hal::cpu::cycles() - next_start;
+  (void)sink;
+
+  // Every 8th gets cancelled and armed again, like an I/O timeout pushed back
+  uint32_t rearmed = 0;
+  const uint64_t cancel_start = hal::cpu::cycles();
+  for (uint32_t i = 0; i < count; i += 8) {
+    wheel.cancel(timeouts[i].timeout);
+    ++rearmed;
+  }
+  const uint64_t cancel_cycles = hal::cpu::cycles() - cancel_start;
+  for (uint32_t i = 0; i < count; i += 8) {
+    wheel.add(timeouts[i].timeout, Span / 2 + i);
+  }
+
+  // 1 ms ticks through the whole span until everything fired
+  uint32_t fired = 0;
+  uint64_t max_advance = 0;
+  const uint64_t expire_start = hal::cpu::cycles();
+  for (uint64_t now = 0; now <= Span + Ms; now += Ms) {
+    const uint64_t t0 = hal::cpu::cycles();
+    fired += wheel.advance(now);
+    const uint64_t took = hal::cpu::cycles() - t0;
+    if (took > max_advance) max_advance = took;
+  }
+  const uint64_t expire_cycles = hal::cpu::cycles() - expire_start;
+  const size_t left = wheel.pending();
+
+  // The wheel outlives the array, nothing of it may stay linked in
+  for (uint32_t i = 0; i < count; ++i) {
+    wheel.cancel(timeouts[i].timeout);
+  }
+  delete[] timeouts;
+
+  write_uint(ctx.tty, count);
+  ctx.tty.write(std::string_view{" timeouts over 10 s, "});
+  write_uint(ctx.tty, fired);
+  ctx.tty.write(std::string_view{" fired, "});
+  write_uint(ctx.tty, left);
+  ctx.tty.write_line(" left");
+  write_per_op(ctx.tty, "insert:      ", add_cycles, count);
+  write_per_op(ctx.tty, "cancel:      ", cancel_cycles, rearmed);
+  write_per_op(ctx.tty, "expire:      ", expire_cycles, fired);
+  write_per_op(ctx.tty, "next expiry: ", next_cycles, 1);
+  write_per_op(ctx.tty, "worst 1 ms advance: ", max_advance, 1);
+  return left || fired != count ? 1 : 0;
+}
+
+int cmd_timers(CommandContext& ctx) noexcept {
+  if (ctx.argc >= 2 && ctx.argv[1] == "bench") {
+    uint32_t count = 100'000;
+    if (ctx.argc >= 3 &&
+        (!parse_uint(ctx.argv[2], count) || !count || count > MaxBenchTimeouts)) {
+      ctx.tty.write_line("Usage: timers bench [COUNT], COUNT up to 250000");
+      return 1;
+    }
+    return bench_timer_wheel(ctx, count);
+  }
+  if (ctx.argc >= 2) {
+    ctx.tty.write(std::string_view{"Unknown option: "});
+    ctx.tty.write_line(ctx.argv[1]);
+    return 1;
+  }
+
+  const auto st = sched::timeout_stats();
+  write_uint(ctx.tty, st.pending);
+  ctx.tty.write(std::string_view{" pending, "});
+  write_uint(ctx.tty, st.wheel.added);
+  ctx.tty.write(std::string_view{" added, "});
+  write_uint(ctx.tty, st.wheel.expired);
+  ctx.tty.write(std::string_view{" expired, "});
+  write_uint(ctx.tty, st.wheel.cancelled);
+  ctx.tty.write(std::string_view{" cancelled, "});
+  write_uint(ctx.tty, st.wheel.cascaded);
+  ctx.tty.write_line(" cascades");
+  return 0;
+}
+
+int cmd_schedbench(CommandContext& ctx) noexcept {
+  if (ctx.argc >= 2) {
+    ctx.tty.write_line("Usage: schedbench");
+    return 1;
+  }
+
+  ctx.tty.write_line("Running, results also go to serial...");
+  ctx.tty.write_line("NAME  THREADS  SAMPLES  MIN  MEDIAN  P99  MAX (cycles)");
+  const bool ok = sched::bench::run_all(
+      [](const sched::bench::Result& r, void* arg) {
+        auto& tty = *static_cast<tty::Tty*>(arg);
+        tty.write(std::string_view{r.name});
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.threads);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.samples);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.min);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.median);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.p99);
+        tty.write(std::string_view{"  "});
+        write_uint(tty, r.max);
+        tty.write_char('\n');
+      },
+      &ctx.tty);
+
+  ctx.tty.write(std::string_view{"Cycle counter at "});
+  write_uint(ctx.tty, hal::cpu::cycles_khz());
+  ctx.tty.write_line(" kHz");
+  if (!ok) {
+    ctx.tty.write_line("Could not run every benchmark");
+    return 1;
+  }
+  return 0;
+}
+
+int cmd_log(CommandContext& ctx) noexcept {
+  for (size_t i = 1; i < ctx.argc; ++i) {
+    if (!logging::configure(ctx.argv[i])) {
+      ctx.tty.write(std::string_view{"Invalid log spec: "});
+      ctx.tty.write_line(ctx.argv[i]);
+      return 1;
+    }
+  }
+
+  for (size_t i = 0; i < logging::SUBSYSTEM_COUNT; ++i) {
+    const auto level = logging::threshold(static_cast<logging::Subsystem>(i));
+    ctx.tty.write(std::string_view{logging::subsystem_names[i]});
+    ctx.tty.write(std::string_view{": "});
+    ctx.tty.write_line(logging::level_names[static_cast<size_t>(level)]);
+  }
+
+  const auto stats = logging::stats();
+  ctx.tty.write(std::string_view{"Suppressed: "});
+  write_uint(ctx.tty, stats.rate_limited);
+  ctx.tty.write(std::string_view{" rate limited, "});
+  write_uint(ctx.tty, stats.repeats);
+  ctx.tty.write_line(" repeats");
+  return 0;
+}
+
 }  // namespace builtin
 
 bool Shell::register_command(const Command& cmd) noexcept {
@@ -66,6 +521,7 @@ bool Shell::register_command(const Command& cmd) noexcept {
 [[noreturn]] void Shell::run() noexcept {
   ctr::String line;
   for (;;) {
+    if (prompt_hook) prompt_hook(prompt_hook_ctx);
     tty.readline(line, prompt);
     execute_line(line);
   }
@@ -97,12 +553,114 @@ void Shell::register_builtin_commands() noexcept {
       .fn = &builtin::cmd_sys,
   };
   register_command(sys_cmd);
+
+  Command trace_cmd{
+      .name = "trace",
+      .help =
+          "Record binary trace events\n"
+          "trace [COMMAND]\n"
+          "Commands:\n"
+          "    start\n"
+          "    stop\n"
+          "    clear\n"
+          "    mark\n"
+          "    dump     - write records to serial, decode with tracedecode.py\n"
+          "    status",
+      .fn = &builtin::cmd_trace,
+  };
+  register_command(trace_cmd);
+
+  Command uptime_cmd{
+      .name = "uptime",
+      .help = "Time since boot and how much of it the cpu spent halted",
+      .fn = &builtin::cmd_uptime,
+  };
+  register_command(uptime_cmd);
+
+  Command ps_cmd{
+      .name = "ps",
+      .help = "List kernel threads",
+      .fn = &builtin::cmd_ps,
+  };
+  register_command(ps_cmd);
+
+  Command wq_cmd{
+      .name = "wq",
+      .help = "Work queue runs and how long queued work waited",
+      .fn = &builtin::cmd_wq,
+  };
+  register_command(wq_cmd);
+
+  Command cpus_cmd{
+      .name = "cpus",
+      .help = "Online cpus and the round trip of a call to each",
+      .fn = &builtin::cmd_cpus,
+  };
+  register_command(cpus_cmd);
+
+  Command heap_cmd{
+      .name = "heap",
+      .help = "Per-cpu allocator caches: how often each size class hit its magazines",
+      .fn = &builtin::cmd_heap,
+  };
+  register_command(heap_cmd);
+
+  Command locks_cmd{
+      .name = "locks",
+      .help = "Lock contention: acquisitions, waits and the longest hold of each lock",
+      .fn = &builtin::cmd_locks,
+  };
+  register_command(locks_cmd);
+
+  Command async_cmd{
+      .name = "async",
+      .help =
+          "Coroutine executor and frame pool statistics\n"
+          "async [tick [COUNT] [INTERVAL_MS]]\n"
+          "    tick  - spawn a coroutine that logs COUNT ticks INTERVAL_MS apart",
+      .fn = &builtin::cmd_async,
+  };
+  register_command(async_cmd);
+
+  Command timers_cmd{
+      .name = "timers",
+      .help =
+          "Timer wheel statistics\n"
+          "timers [bench [COUNT]]\n"
+          "    bench - time insert, cancel and expiry with COUNT (100000, at most\n"
+          "            250000) timeouts",
+      .fn = &builtin::cmd_timers,
+  };
+  register_command(timers_cmd);
+
+  Command schedbench_cmd{
+      .name = "schedbench",
+      .help = "Time yield round trips, timer wakeups and switches with up to 32 threads",
+      .fn = &builtin::cmd_schedbench,
+  };
+  register_command(schedbench_cmd);
+
+  Command log_cmd{
+      .name = "log",
+      .help =
+          "Show or set log thresholds\n"
+          "log [[SUBSYSTEM:]LEVEL,...]\n"
+          "Levels: trace, debug, info, warn, error, off\n"
+          "Subsystems: kernel, boot, mem, drv, gfx, shell, sched",
+      .fn = &builtin::cmd_log,
+  };
+  register_command(log_cmd);
 }
 
 void Shell::set_prompt(std::string_view prompt) noexcept {
   this->prompt = prompt;
 }
 
+void Shell::set_prompt_hook(void (*fn)(void* ctx), void* ctx) noexcept {
+  prompt_hook = fn;
+  prompt_hook_ctx = ctx;
+}
+
 Command* Shell::find_cmd(std::string_view name) noexcept {
   if (name.size() == 0) return nullptr;
 
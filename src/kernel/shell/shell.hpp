@@ -41,6 +41,9 @@ class Shell {
 
   void set_prompt(std::string_view prompt) noexcept;
 
+  /// Called right before every prompt, when the last command's output is complete.
+  void set_prompt_hook(void (*fn)(void* ctx), void* ctx) noexcept;
+
   tty::Tty& get_tty() noexcept { return tty; }
 
   size_t cmd_count() const noexcept { return cmd_len; }
@@ -55,5 +58,7 @@ class Shell {
   Command cmds[MAX_COMMANDS];
   size_t cmd_len{0};
   std::string_view prompt;
+  void (*prompt_hook)(void* ctx){nullptr};
+  void* prompt_hook_ctx{nullptr};
 };
 }  // namespace shell
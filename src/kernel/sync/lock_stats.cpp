@@ -0,0 +1,27 @@
+#include "sync/lock_stats.hpp"
+
+#include <atomic>
+
+namespace sync {
+
+namespace {
+std::atomic<LockStats*> all_stats{nullptr};
+}  // namespace
+
+void LockStats::add_to_list() noexcept {
+  if (listed.exchange(true, std::memory_order_acq_rel)) return;
+
+  LockStats* head = all_stats.load(std::memory_order_relaxed);
+  do {
+    next = head;
+  } while (!all_stats.compare_exchange_weak(head, this, std::memory_order_release,
+                                            std::memory_order_relaxed));
+}
+
+void for_each_lock(void (*fn)(const LockStats& stats, void* ctx), void* ctx) noexcept {
+  for (const LockStats* s = all_stats.load(std::memory_order_acquire); s; s = s->next) {
+    fn(*s, ctx);
+  }
+}
+
+}  // namespace sync
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace sync {
+
+/// Contention counters of one lock, handed to its constructor. Locks without one skip
+/// all accounting. The exclusive counters are only written by the holder, so one
+/// LockStats must not be shared between locks. Listed for `for_each_lock` on first use.
+struct LockStats {
+  constexpr explicit LockStats(const char* name) noexcept : name(name) {}
+
+  LockStats(const LockStats&) = delete;
+  LockStats& operator=(const LockStats&) = delete;
+
+  const char* name;
+
+  uint64_t acquisitions{0};
+  uint64_t contended{0};  // Acquisitions that had to wait
+  uint64_t spins{0};      // Wait loop iterations over all contended acquisitions
+  uint64_t max_hold_cycles{0};
+  std::atomic<uint32_t> shared_acquisitions{0};  // Readers, counted without the lock
+
+  LockStats* next{nullptr};
+  std::atomic<bool> listed{false};
+
+  /// Called by the new holder right after acquiring.
+  void acquired(uint64_t waited_spins) noexcept {
+    ++acquisitions;
+    if (waited_spins) {
+      ++contended;
+      spins += waited_spins;
+    }
+    list();
+  }
+
+  /// Called by the holder right before releasing.
+  void released(uint64_t held_cycles) noexcept {
+    if (held_cycles > max_hold_cycles) max_hold_cycles = held_cycles;
+  }
+
+  void acquired_shared() noexcept {
+    shared_acquisitions.fetch_add(1, std::memory_order_relaxed);
+    list();
+  }
+
+ private:
+  void list() noexcept {
+    if (!listed.load(std::memory_order_relaxed)) add_to_list();
+  }
+  void add_to_list() noexcept;
+};
+
+/// Call `fn` for every lock that recorded something so far.
+void for_each_lock(void (*fn)(const LockStats& stats, void* ctx), void* ctx) noexcept;
+
+}  // namespace sync
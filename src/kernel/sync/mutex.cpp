@@ -0,0 +1,46 @@
+#include "sync/mutex.hpp"
+
+#include <atomic>
+#include <cstdint>
+
+#include <kernel/panic.hpp>
+
+#include "hal/cycles.hpp"
+#include "sched/sched.hpp"
+
+namespace sync {
+
+void Mutex::on_acquired(uint64_t waits) noexcept {
+  owner = sched::started() ? sched::current() : nullptr;
+  if (!stats) return;
+  stats->acquired(waits);
+  acquired_at = hal::cpu::cycles();
+}
+
+void Mutex::lock() noexcept {
+  uint64_t waits = 0;
+  while (!try_acquire()) {
+    // `spins` counts trips through the wait queue here, not pause loops
+    ++waits;
+    waiters.wait_while([this] { return locked.load(std::memory_order_relaxed); });
+  }
+  on_acquired(waits);
+}
+
+bool Mutex::try_lock() noexcept {
+  if (!try_acquire()) return false;
+  on_acquired(0);
+  return true;
+}
+
+void Mutex::unlock() noexcept {
+  if (owner && owner != sched::current()) {
+    panic("Mutex %p unlocked by a thread not holding it", static_cast<void*>(this));
+  }
+  if (stats) stats->released(hal::cpu::cycles() - acquired_at);
+  owner = nullptr;
+  locked.store(false, std::memory_order_release);
+  waiters.wake_one();
+}
+
+}  // namespace sync
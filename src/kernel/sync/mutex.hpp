@@ -0,0 +1,42 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "sched/sched.hpp"
+#include "sync/lock_stats.hpp"
+#include "sync/wait_queue.hpp"
+
+namespace sync {
+
+/// Sleeping lock for threads, for sections that may block or run long. Never take it in
+/// an interrupt handler. Not recursive.
+class Mutex {
+ public:
+  constexpr Mutex() noexcept = default;
+  constexpr explicit Mutex(LockStats* stats) noexcept : stats(stats) {}
+
+  Mutex(const Mutex&) = delete;
+  Mutex& operator=(const Mutex&) = delete;
+
+  void lock() noexcept;
+  bool try_lock() noexcept;
+  void unlock() noexcept;
+
+  /// Thread holding it, nullptr when free.
+  sched::Thread* holder() const noexcept { return owner; }
+
+ private:
+  bool try_acquire() noexcept {
+    return !locked.exchange(true, std::memory_order_acquire);
+  }
+  void on_acquired(uint64_t waits) noexcept;
+
+  std::atomic<bool> locked{false};
+  WaitQueue waiters;
+  LockStats* stats{nullptr};
+  sched::Thread* owner{nullptr};
+  uint64_t acquired_at{0};  // Holder only
+};
+
+}  // namespace sync
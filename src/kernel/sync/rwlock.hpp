@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "hal/cycles.hpp"
+#include "sync/lock_stats.hpp"
+#include "sync/spinlock.hpp"
+
+namespace sync {
+
+/// Many readers or one writer. A waiting writer keeps new readers out, so a steady
+/// stream of readers cannot starve it. Does not touch interrupts.
+class RwSpinLock {
+ public:
+  constexpr RwSpinLock() noexcept = default;
+  constexpr explicit RwSpinLock(LockStats* stats) noexcept : stats(stats) {}
+
+  RwSpinLock(const RwSpinLock&) = delete;
+  RwSpinLock& operator=(const RwSpinLock&) = delete;
+
+  void read_lock() noexcept {
+    for (;;) {
+      uint32_t s = state.load(std::memory_order_relaxed);
+      if (!(s & (Writer | Pending)) &&
+          state.compare_exchange_weak(s, s + 1, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+      cpu_relax();
+    }
+    if (stats) stats->acquired_shared();
+  }
+
+  void read_unlock() noexcept { state.fetch_sub(1, std::memory_order_release); }
+
+  void write_lock() noexcept {
+    uint64_t spins = 0;
+    for (;;) {
+      uint32_t s = state.load(std::memory_order_relaxed);
+      // Taking it clears Pending, other waiting writers set it again below
+      if ((s & ~Pending) == 0 &&
+          state.compare_exchange_weak(s, Writer, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+        break;
+      }
+      if (!(s & Pending)) state.fetch_or(Pending, std::memory_order_relaxed);
+      cpu_relax();
+      ++spins;
+    }
+    if (stats) {
+      stats->acquired(spins);
+      acquired_at = hal::cpu::cycles();
+    }
+  }
+
+  void write_unlock() noexcept {
+    if (stats) stats->released(hal::cpu::cycles() - acquired_at);
+    state.fetch_and(~Writer, std::memory_order_release);
+  }
+
+ private:
+  static constexpr uint32_t Writer = 1u << 31;
+  static constexpr uint32_t Pending = 1u << 30;  // A writer waits, readers hold back
+
+  std::atomic<uint32_t> state{0};  // Writer | Pending | reader count
+  LockStats* stats{nullptr};
+  uint64_t acquired_at{0};  // Writer only
+};
+
+class ReadGuard {
+ public:
+  explicit ReadGuard(RwSpinLock& lock) noexcept : lock(lock) { lock.read_lock(); }
+  ~ReadGuard() { lock.read_unlock(); }
+
+  ReadGuard(const ReadGuard&) = delete;
+  ReadGuard& operator=(const ReadGuard&) = delete;
+
+ private:
+  RwSpinLock& lock;
+};
+
+class WriteGuard {
+ public:
+  explicit WriteGuard(RwSpinLock& lock) noexcept : lock(lock) { lock.write_lock(); }
+  ~WriteGuard() { lock.write_unlock(); }
+
+  WriteGuard(const WriteGuard&) = delete;
+  WriteGuard& operator=(const WriteGuard&) = delete;
+
+ private:
+  RwSpinLock& lock;
+};
+
+}  // namespace sync
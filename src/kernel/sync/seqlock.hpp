@@ -0,0 +1,61 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "sync/lock_stats.hpp"
+#include "sync/spinlock.hpp"
+
+namespace sync {
+
+/// For small, often read and rarely written data. Readers take no lock at all, they
+/// copy the data and retry when a writer got in between:
+///
+///   uint32_t seq;
+///   do {
+///     seq = lock.read_begin();
+///     copy = shared;
+///   } while (lock.read_retry(seq));
+///
+/// Writers serialize on a spinlock with interrupts off, so readers in handlers never
+/// spin on a writer they interrupted. The data itself must be safe to read torn (plain
+/// integers, no pointers that get freed), the retry only throws such copies away.
+class SeqLock {
+ public:
+  constexpr SeqLock() noexcept = default;
+  constexpr explicit SeqLock(LockStats* stats) noexcept : writer(stats), stats(stats) {}
+
+  void write_lock() noexcept {
+    writer.lock();
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
+
+  void write_unlock() noexcept {
+    seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    writer.unlock();
+  }
+
+  /// Start of a read section, waits out a writer that is in the middle of an update.
+  uint32_t read_begin() const noexcept {
+    if (stats) stats->acquired_shared();
+    uint32_t s;
+    while ((s = seq.load(std::memory_order_acquire)) & 1) {
+      cpu_relax();
+    }
+    return s;
+  }
+
+  /// True when a writer changed the data since `read_begin` returned `start`.
+  bool read_retry(uint32_t start) const noexcept {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return seq.load(std::memory_order_relaxed) != start;
+  }
+
+ private:
+  std::atomic<uint32_t> seq{0};  // Odd while a write is in progress
+  IrqSpinLock writer;
+  LockStats* stats{nullptr};
+};
+
+}  // namespace sync
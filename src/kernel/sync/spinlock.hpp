@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#include "hal/cycles.hpp"
+#include "hal/interrupts.hpp"
+#include "sync/lock_stats.hpp"
+
+namespace sync {
+
+/// Busy-wait hint for spin loops.
+inline void cpu_relax() noexcept {
+  asm volatile("pause" ::: "memory");
+}
+
+/// Ticket lock: cpus get the lock in the order they asked for it, so none starves under
+/// contention. Does not touch interrupts: a lock also taken by a handler wants
+/// `IrqSpinLock`, and a thread preempted while holding one leaves the others spinning
+/// through their whole slice.
+class SpinLock {
+ public:
+  constexpr SpinLock() noexcept = default;
+  constexpr explicit SpinLock(LockStats* stats) noexcept : stats(stats) {}
+
+  SpinLock(const SpinLock&) = delete;
+  SpinLock& operator=(const SpinLock&) = delete;
+
+  void lock() noexcept {
+    const uint32_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+    uint64_t spins = 0;
+    while (serving.load(std::memory_order_acquire) != ticket) {
+      cpu_relax();
+      ++spins;
+    }
+    on_acquired(spins);
+  }
+
+  bool try_lock() noexcept {
+    uint32_t ticket = serving.load(std::memory_order_relaxed);
+    if (!next.compare_exchange_strong(ticket, ticket + 1, std::memory_order_acquire,
+                                      std::memory_order_relaxed)) {
+      return false;
+    }
+    on_acquired(0);
+    return true;
+  }
+
+  void unlock() noexcept {
+    if (stats) stats->released(hal::cpu::cycles() - acquired_at);
+    // Only the holder writes `serving`, a plain increment is enough
+    serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  }
+
+  bool is_locked() const noexcept {
+    return next.load(std::memory_order_relaxed) !=
+           serving.load(std::memory_order_relaxed);
+  }
+
+ private:
+  void on_acquired(uint64_t spins) noexcept {
+    if (!stats) return;
+    stats->acquired(spins);
+    acquired_at = hal::cpu::cycles();
+  }
+
+  std::atomic<uint32_t> next{0};
+  std::atomic<uint32_t> serving{0};
+  LockStats* stats{nullptr};
+  uint64_t acquired_at{0};  // Holder only
+};
+
+/// Spinlock that keeps interrupts off on this cpu while held, for data shared with
+/// interrupt handlers. Interrupts go off before spinning, so a handler can never spin on
+/// a lock its own cpu holds.
+class IrqSpinLock {
+ public:
+  constexpr IrqSpinLock() noexcept = default;
+  constexpr explicit IrqSpinLock(LockStats* stats) noexcept : inner(stats) {}
+
+  void lock() noexcept {
+    const bool was_enabled = hal::irq::save_and_disable();
+    inner.lock();
+    irq_was_enabled = was_enabled;
+  }
+
+  bool try_lock() noexcept {
+    const bool was_enabled = hal::irq::save_and_disable();
+    if (!inner.try_lock()) {
+      hal::irq::restore(was_enabled);
+      return false;
+    }
+    irq_was_enabled = was_enabled;
+    return true;
+  }
+
+  void unlock() noexcept {
+    const bool was_enabled = irq_was_enabled;
+    inner.unlock();
+    hal::irq::restore(was_enabled);
+  }
+
+  bool is_locked() const noexcept { return inner.is_locked(); }
+
+ private:
+  SpinLock inner;
+  bool irq_was_enabled{false};  // Holder only
+};
+
+/// Holds any lock with lock/unlock for the lifetime of the guard.
+template <typename Lock>
+class LockGuard {
+ public:
+  explicit LockGuard(Lock& lock) noexcept : lock(lock) { lock.lock(); }
+  ~LockGuard() { lock.unlock(); }
+
+  LockGuard(const LockGuard&) = delete;
+  LockGuard& operator=(const LockGuard&) = delete;
+
+ private:
+  Lock& lock;
+};
+
+}  // namespace sync
@@ -0,0 +1,60 @@
+#include "sync/wait_queue.hpp"
+
+#include <cstdint>
+
+#include "hal/interrupts.hpp"
+#include "sched/sched.hpp"
+
+namespace sync {
+
+void WaitQueue::enqueue(Waiter& waiter) noexcept {
+  if (tail) {
+    tail->next = &waiter;
+  } else {
+    head = &waiter;
+  }
+  tail = &waiter;
+}
+
+bool WaitQueue::wake_one() noexcept {
+  sched::Thread* thread = nullptr;
+  {
+    hal::irq::Guard guard;
+    lock.lock();
+    if (Waiter* w = head) {
+      head = w->next;
+      if (!head) tail = nullptr;
+      // The waiter's stack frame is gone once its thread runs again, read it first
+      thread = w->thread;
+    }
+    lock.unlock();
+  }
+
+  // With interrupts back on a more urgent waiter takes over right here
+  if (!thread) return false;
+  sched::wake(thread);
+  return true;
+}
+
+uint32_t WaitQueue::wake_all() noexcept {
+  Waiter* w;
+  {
+    hal::irq::Guard guard;
+    lock.lock();
+    w = head;
+    head = tail = nullptr;
+    lock.unlock();
+  }
+
+  // Unlinked waiters stay blocked until woken here, so each frame lives until then
+  uint32_t count = 0;
+  while (w) {
+    Waiter* next = w->next;
+    sched::wake(w->thread);
+    w = next;
+    ++count;
+  }
+  return count;
+}
+
+}  // namespace sync
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "hal/interrupts.hpp"
+#include "sched/sched.hpp"
+#include "sync/spinlock.hpp"
+
+namespace sync {
+
+/// Threads sleeping until a condition holds. The condition is checked under the queue's
+/// lock, and wakers change it before calling `wake_*`, so no wakeup gets lost in
+/// between. Waiting is for threads only, waking is fine from interrupt handlers.
+class WaitQueue {
+ public:
+  constexpr WaitQueue() noexcept = default;
+
+  WaitQueue(const WaitQueue&) = delete;
+  WaitQueue& operator=(const WaitQueue&) = delete;
+
+  /// Sleep as long as `cond()` is true. Before the scheduler runs it spins instead.
+  template <typename Cond>
+  void wait_while(Cond cond) noexcept {
+    if (!sched::started()) {
+      while (cond()) {
+        cpu_relax();
+      }
+      return;
+    }
+
+    const bool was_enabled = hal::irq::save_and_disable();
+    for (;;) {
+      lock.lock();
+      if (!cond()) {
+        lock.unlock();
+        break;
+      }
+      Waiter self{sched::current(), nullptr};
+      enqueue(self);
+      lock.unlock();
+      // Interrupts stay off until `block` switched away, a waker cannot slip in before
+      sched::block();
+    }
+    hal::irq::restore(was_enabled);
+  }
+
+  /// Wake the longest waiting thread. Returns false when nobody waited.
+  bool wake_one() noexcept;
+  /// Wake every waiting thread, returns how many.
+  uint32_t wake_all() noexcept;
+
+  bool empty() const noexcept { return !head; }
+
+ private:
+  /// Lives on the waiting thread's stack while it sleeps.
+  struct Waiter {
+    sched::Thread* thread;
+    Waiter* next;
+  };
+
+  void enqueue(Waiter& waiter) noexcept;
+
+  SpinLock lock;
+  Waiter* head{nullptr};
+  Waiter* tail{nullptr};
+};
+
+}  // namespace sync
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace trace {
+
+/// How an event shows up on the timeline. Begin/End pairs become slices, everything else
+/// a marker.
+enum class Kind : uint8_t {
+  Instant,
+  Begin,
+  End,
+};
+
+enum class Event : uint16_t {
+  PageMap,
+  PageUnmap,
+  FrameAlloc,
+  FrameFree,
+  HeapAlloc,
+  HeapFree,
+  RedrawBegin,
+  RedrawEnd,
+  Mark,
+  Count,
+};
+
+struct EventInfo {
+  const char* name;
+  Kind kind;
+};
+
+/// Indexed by Event. Dumps carry this table, so the host decoder needs no copy of it.
+inline constexpr EventInfo event_infos[] = {
+    {"page_map", Kind::Instant},   {"page_unmap", Kind::Instant},
+    {"frame_alloc", Kind::Instant}, {"frame_free", Kind::Instant},
+    {"heap_alloc", Kind::Instant}, {"heap_free", Kind::Instant},
+    {"redraw", Kind::Begin},       {"redraw", Kind::End},
+    {"mark", Kind::Instant},
+};
+
+static_assert(sizeof(event_infos) / sizeof(event_infos[0]) ==
+                  static_cast<size_t>(Event::Count),
+              "Every trace event needs an entry in event_infos");
+
+}  // namespace trace
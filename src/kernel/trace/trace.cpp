@@ -0,0 +1,166 @@
+#include "trace/trace.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include <kernel/log_format.hpp>
+
+#include "hal/cycles.hpp"
+#include "hal/smp.hpp"
+#include "logging/logging.hpp"
+
+namespace trace {
+
+namespace {
+static_assert((RECORDS_PER_CPU & (RECORDS_PER_CPU - 1)) == 0,
+              "RECORDS_PER_CPU must be a power of two");
+
+constexpr uint32_t Mask = RECORDS_PER_CPU - 1;
+
+/// Only ever written by its own cpu, so the only writer racing with itself is an
+/// interrupt handler, which reserves its own slot before filling it.
+struct Buffer {
+  Record records[RECORDS_PER_CPU];
+  std::atomic<uint32_t> head{0};
+  uint32_t tail{0};
+};
+
+Buffer buffers[MAX_CPUS];
+
+uint32_t this_cpu() noexcept {
+  return hal::smp::cpu_id();
+}
+
+size_t held(const Buffer& b) noexcept {
+  const uint32_t n = b.head.load(std::memory_order_acquire) - b.tail;
+  return n > RECORDS_PER_CPU ? RECORDS_PER_CPU : n;
+}
+
+void put_hex(logging::format::LineWriter& out, uint64_t v) noexcept {
+  out.put_char(' ');
+  out.put_uint(v, 16, false);
+}
+}  // namespace
+
+namespace internal {
+std::atomic<bool> enabled{false};
+
+void record(Event event, uint8_t argc, uint32_t a0, uint32_t a1, uint32_t a2,
+            uint32_t a3) noexcept {
+  const uint32_t cpu = this_cpu();
+  Buffer& b = buffers[cpu];
+
+  const uint32_t seq = b.head.fetch_add(1, std::memory_order_relaxed);
+  Record& r = b.records[seq & Mask];
+  r.timestamp = hal::cpu::cycles();
+  r.seq = seq;
+  r.event = static_cast<uint16_t>(event);
+  r.cpu = static_cast<uint8_t>(cpu);
+  r.argc = argc;
+  r.args[0] = a0;
+  r.args[1] = a1;
+  r.args[2] = a2;
+  r.args[3] = a3;
+}
+}  // namespace internal
+
+void start() noexcept {
+  internal::enabled.store(true, std::memory_order_release);
+}
+
+void stop() noexcept {
+  internal::enabled.store(false, std::memory_order_release);
+}
+
+bool running() noexcept {
+  return internal::enabled.load(std::memory_order_relaxed);
+}
+
+void clear() noexcept {
+  for (auto& b : buffers) {
+    b.tail = b.head.load(std::memory_order_acquire);
+  }
+}
+
+size_t recorded() noexcept {
+  size_t total = 0;
+  for (const auto& b : buffers) {
+    total += held(b);
+  }
+  return total;
+}
+
+size_t overwritten() noexcept {
+  size_t total = 0;
+  for (const auto& b : buffers) {
+    const uint32_t n = b.head.load(std::memory_order_acquire) - b.tail;
+    if (n > RECORDS_PER_CPU) total += n - RECORDS_PER_CPU;
+  }
+  return total;
+}
+
+// Format, one record per line, all numbers hex:
+//   #trace begin <version> <cpus> <clock khz> <records>
+//   #trace event <id> <kind> <name>
+//   #trace rec <cpu> <seq> <timestamp> <event> <argc> <arg0> <arg1> <arg2> <arg3>
+//   #trace end
+void dump() noexcept {
+  using logging::format::LineWriter;
+
+  const bool was_running = running();
+  stop();
+
+  {
+    LineWriter out;
+    out.put_cstr("#trace begin 1");
+    put_hex(out, MAX_CPUS);
+    put_hex(out, hal::cpu::cycles_khz());
+    put_hex(out, recorded());
+    out.put_char('\n');
+  }
+
+  for (size_t id = 0; id < static_cast<size_t>(Event::Count); ++id) {
+    LineWriter out;
+    out.put_cstr("#trace event");
+    put_hex(out, id);
+    put_hex(out, static_cast<uint32_t>(event_infos[id].kind));
+    out.put_char(' ');
+    out.put_cstr(event_infos[id].name);
+    out.put_char('\n');
+  }
+
+  for (const auto& b : buffers) {
+    const uint32_t head = b.head.load(std::memory_order_acquire);
+    for (uint32_t seq = head - static_cast<uint32_t>(held(b)); seq != head; ++seq) {
+      const Record& r = b.records[seq & Mask];
+
+      {
+        LineWriter out;
+        out.put_cstr("#trace rec");
+        put_hex(out, r.cpu);
+        put_hex(out, r.seq);
+        put_hex(out, r.timestamp);
+        put_hex(out, r.event);
+        put_hex(out, r.argc);
+        for (uint32_t arg : r.args) {
+          put_hex(out, arg);
+        }
+        out.put_char('\n');
+      }
+
+      // Buffering sinks only hold a few KiB, push each line out before the next one
+      logging::backend::flush();
+    }
+  }
+
+  {
+    LineWriter out;
+    out.put_cstr("#trace end\n");
+  }
+  logging::backend::flush();
+
+  if (was_running) start();
+}
+
+}  // namespace trace
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/smp.hpp"
+#include "trace/events.hpp"
+
+namespace trace {
+
+/// One fixed size binary trace record. Arguments the event does not use are 0.
+struct Record {
+  uint64_t timestamp;
+  uint32_t seq;
+  uint16_t event;
+  uint8_t cpu;
+  uint8_t argc;
+  uint32_t args[4];
+};
+
+static_assert(sizeof(Record) == 32);
+
+inline constexpr size_t MAX_CPUS = hal::smp::MAX_CPUS;
+inline constexpr size_t RECORDS_PER_CPU = 1024;
+
+namespace internal {
+extern std::atomic<bool> enabled;
+
+void record(Event event, uint8_t argc, uint32_t a0, uint32_t a1, uint32_t a2,
+            uint32_t a3) noexcept;
+}  // namespace internal
+
+/// Cheap enough to leave in hot paths: while tracing is stopped this is one load.
+template <typename... Args>
+  requires(sizeof...(Args) <= 4)
+inline void emit(Event event, Args... args) noexcept {
+  if (!internal::enabled.load(std::memory_order_relaxed)) return;
+
+  uint32_t a[4]{static_cast<uint32_t>(args)...};
+  internal::record(event, sizeof...(Args), a[0], a[1], a[2], a[3]);
+}
+
+/// Emits the Begin event on construction and the matching End event when the scope is
+/// left.
+class Scope {
+ public:
+  Scope(Event begin, Event end) noexcept : end(end) { emit(begin); }
+  ~Scope() { emit(end); }
+
+  Scope(const Scope&) = delete;
+  Scope& operator=(const Scope&) = delete;
+
+ private:
+  Event end;
+};
+
+void start() noexcept;
+void stop() noexcept;
+bool running() noexcept;
+
+/// Forget everything recorded so far.
+void clear() noexcept;
+
+/// Records currently held and records lost to overwrite-oldest, over all cpus.
+size_t recorded() noexcept;
+size_t overwritten() noexcept;
+
+/// Write every held record to the log sink as text lines the host decoder
+/// (tracedecode.py) understands. Recording is paused while dumping.
+void dump() noexcept;
+
+}  // namespace trace
@@ -0,0 +1,209 @@
+#include "tty/serial_console.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+#include "hal/keyboard.hpp"
+#include "input/keymap.hpp"
+#include "math/int_format.hpp"
+#include "sched/idle.hpp"
+
+namespace tty {
+
+void SerialDisplay::put_char(char c) noexcept {
+  if (c == '\n') {
+    put_raw("\r\n", 2);
+    col = 0;
+    ++row;
+    line_len = 0;
+    return;
+  }
+
+  put_raw(&c, 1);
+  ++col;
+  if (col > line_len) line_len = col;
+}
+
+void SerialDisplay::backspace() noexcept {
+  if (!col) return;
+
+  put_raw("\b \b", 3);
+  --col;
+  if (line_len) --line_len;
+}
+
+void SerialDisplay::flush() noexcept {
+  if (len) port.write(reinterpret_cast<const uint8_t*>(buf), len);
+  len = 0;
+}
+
+void SerialDisplay::move_left(size_t amount) noexcept {
+  if (amount > col) amount = col;
+  csi(amount, 'D');
+  col -= static_cast<uint32_t>(amount);
+}
+
+void SerialDisplay::move_right(size_t amount) noexcept {
+  if (col + amount > line_len) amount = line_len - col;
+  csi(amount, 'C');
+  col += static_cast<uint32_t>(amount);
+}
+
+void SerialDisplay::move_up(size_t amount) noexcept {
+  csi(amount, 'A');
+}
+
+void SerialDisplay::move_down(size_t amount) noexcept {
+  csi(amount, 'B');
+}
+
+void SerialDisplay::move_line_end() noexcept {
+  move_right(line_len - col);
+}
+
+void SerialDisplay::move_end() noexcept {
+  move_line_end();
+}
+
+void SerialDisplay::put_raw(const char* s, size_t n) noexcept {
+  for (size_t i = 0; i < n; ++i) {
+    if (len == BufferSize) flush();
+    buf[len++] = s[i];
+  }
+}
+
+void SerialDisplay::csi(size_t amount, char cmd) noexcept {
+  if (!amount) return;
+
+  char digits[math::MAX_INT_DIGITS];
+  char* end = digits + sizeof(digits);
+  char* begin = math::format_uint(amount, 10, false, end);
+
+  put_raw("\x1b[", 2);
+  put_raw(begin, static_cast<size_t>(end - begin));
+  put_raw(&cmd, 1);
+}
+
+bool SerialKeyboard::poll(hal::KeyEvent& ev) noexcept {
+  uint8_t b;
+  while (port.read_byte(b)) {
+    if (decode(b, ev)) return true;
+  }
+  return false;
+}
+
+void SerialKeyboard::wait_event(hal::KeyEvent& ev) noexcept {
+  while (!poll(ev)) {
+    if (port.rx_irq_driven()) {
+      sched::idle_wait([this] { return port.rx_pending(); });
+    } else {
+      sched::run_idle_hooks();
+    }
+  }
+}
+
+bool SerialKeyboard::decode(uint8_t b, hal::KeyEvent& ev) noexcept {
+  using hal::Key;
+
+  auto press = [&](Key key) {
+    ev = hal::KeyEvent{key, hal::KeyEventType::Press, hal::KeyMod::None, 0, false};
+    return true;
+  };
+
+  switch (state) {
+    case State::Escape:
+      if (b == '[' || b == 'O') {
+        state = State::Csi;
+        param = 0;
+        return false;
+      }
+      state = State::Ground;
+      return press(Key::Esc);
+
+    case State::Csi:
+      if (b >= '0' && b <= '9') {
+        param = static_cast<uint8_t>(param * 10 + (b - '0'));
+        return false;
+      }
+      state = State::Ground;
+      return csi_final(b, ev);
+
+    case State::Ground:
+      break;
+  }
+
+  const bool after_cr = last_was_cr;
+  last_was_cr = b == '\r';
+
+  switch (b) {
+    case 0x1b:
+      state = State::Escape;
+      return false;
+    case '\r':
+      return press(Key::Enter);
+    case '\n':
+      // Terminals sending CRLF only pressed Enter once
+      return after_cr ? false : press(Key::Enter);
+    case 0x7f:
+    case '\b':
+      return press(Key::Backspace);
+    case '\t':
+      return press(Key::Tab);
+    default:
+      return input::char_to_key_event(static_cast<char>(b), ev);
+  }
+}
+
+bool SerialKeyboard::csi_final(uint8_t b, hal::KeyEvent& ev) noexcept {
+  using hal::Key;
+
+  Key key = Key::Unknown;
+  switch (b) {
+    case 'A':
+      key = Key::Up;
+      break;
+    case 'B':
+      key = Key::Down;
+      break;
+    case 'C':
+      key = Key::Right;
+      break;
+    case 'D':
+      key = Key::Left;
+      break;
+    case 'H':
+      key = Key::Home;
+      break;
+    case 'F':
+      key = Key::End;
+      break;
+    case '~':
+      switch (param) {
+        case 1:
+        case 7:
+          key = Key::Home;
+          break;
+        case 3:
+          key = Key::Delete;
+          break;
+        case 4:
+        case 8:
+          key = Key::End;
+          break;
+        case 5:
+          key = Key::PageUp;
+          break;
+        case 6:
+          key = Key::PageDown;
+          break;
+      }
+      break;
+  }
+
+  if (key == Key::Unknown) return false;
+
+  ev = hal::KeyEvent{key, hal::KeyEventType::Press, hal::KeyMod::None, 0, true};
+  return true;
+}
+
+}  // namespace tty
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "drv/serial/serial.hpp"
+#include "hal/keyboard.hpp"
+#include "tty/display.hpp"
+
+namespace tty {
+
+/// Display on the other end of a serial line, assumed to be a VT100 compatible
+/// terminal. Output is collected until `flush` and then goes out in one write.
+class SerialDisplay final : public Display {
+ public:
+  SerialDisplay(const SerialDisplay&) = delete;
+  SerialDisplay(SerialDisplay&&) = delete;
+  SerialDisplay& operator=(const SerialDisplay&) = delete;
+  SerialDisplay& operator=(SerialDisplay&&) = delete;
+
+  explicit SerialDisplay(drv::serial::Port& port) noexcept : port(port) {}
+
+  void put_char(char c) noexcept override;
+  void backspace() noexcept override;
+  void flush() noexcept override;
+
+  // The terminal keeps its own scrollback
+  void scroll_up(size_t) noexcept override {}
+  void scroll_down(size_t) noexcept override {}
+
+  void move_left(size_t amount) noexcept override;
+  void move_right(size_t amount) noexcept override;
+  void move_up(size_t amount) noexcept override;
+  void move_down(size_t amount) noexcept override;
+  void move_line_end() noexcept override;
+  void move_end() noexcept override;
+
+  gfx::Point cursor() noexcept override { return {col, row}; }
+  size_t get_line_length() const noexcept override { return Columns; }
+
+ private:
+  static constexpr size_t Columns = 80;
+  static constexpr size_t BufferSize = 128;
+
+  void put_raw(const char* s, size_t len) noexcept;
+  void csi(size_t amount, char cmd) noexcept;
+
+  drv::serial::Port& port;
+  char buf[BufferSize];
+  size_t len{0};
+  uint32_t col{0};
+  uint32_t row{0};
+  uint32_t line_len{0};
+};
+
+/// Turns the bytes a terminal sends into key events: text through the keymap in
+/// reverse, CR/LF as Enter, DEL/BS as Backspace and the usual escape sequences for
+/// the cursor and paging keys.
+class SerialKeyboard final : public hal::Keyboard {
+ public:
+  SerialKeyboard(const SerialKeyboard&) = delete;
+  SerialKeyboard(SerialKeyboard&&) = delete;
+  SerialKeyboard& operator=(const SerialKeyboard&) = delete;
+  SerialKeyboard& operator=(SerialKeyboard&&) = delete;
+
+  explicit SerialKeyboard(drv::serial::Port& port) noexcept : port(port) {}
+
+  bool poll(hal::KeyEvent& ev) noexcept override;
+  void wait_event(hal::KeyEvent& ev) noexcept override;
+
+ private:
+  enum class State : uint8_t {
+    Ground,
+    Escape,
+    Csi,
+  };
+
+  bool decode(uint8_t b, hal::KeyEvent& ev) noexcept;
+  bool csi_final(uint8_t b, hal::KeyEvent& ev) noexcept;
+
+  drv::serial::Port& port;
+  State state{State::Ground};
+  uint8_t param{0};
+  bool last_was_cr{false};
+};
+
+}  // namespace tty
@@ -37,7 +37,7 @@ char Tty::read_char_blocking() noexcept {
     hal::KeyEvent ev{};
     char c = 0;
 
-    if (!keyboard.poll(ev)) continue;
+    keyboard.wait_event(ev);
     if (ev.type == hal::KeyEventType::Release) continue;
     if (!input::key_event_to_char(ev, c)) continue;
 
@@ -53,7 +53,7 @@ void Tty::readline(ctr::String& out, std::string_view prompt) noexcept {
     hal::KeyEvent ev{};
     char c = 0;
 
-    if (!keyboard.poll(ev)) continue;
+    keyboard.wait_event(ev);
     if (ev.type == hal::KeyEventType::Release) continue;
 
     if (!input::key_event_to_char(ev, c)) {
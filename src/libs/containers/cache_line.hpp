@@ -0,0 +1,10 @@
+#pragma once
+#include <cstddef>
+
+namespace ctr {
+
+/// Alignment that keeps data written by different cpus off each other's cache lines.
+/// 64 bytes on every x86 since the Pentium 4.
+inline constexpr size_t CACHE_LINE_SIZE = 64;
+
+}  // namespace ctr
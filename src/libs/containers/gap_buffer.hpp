@@ -127,7 +127,45 @@ class GapBuffer {
 
   size_t count() const { return length; }
 
+  /// Index of the first value at or after from, count() if there is none.
+  size_t find(const T& value, size_t from = 0) const {
+    size_t prefix_len = static_cast<size_t>(gap_begin - begin);
+
+    if (from < prefix_len) {
+      const T* hit = scan(begin + from, prefix_len - from, value);
+      if (hit) return static_cast<size_t>(hit - begin);
+      from = prefix_len;
+    }
+
+    if (from < length) {
+      const T* hit = scan(gap_end + (from - prefix_len), length - from, value);
+      if (hit) return prefix_len + static_cast<size_t>(hit - gap_end);
+    }
+
+    return length;
+  }
+
+  size_t count_of(const T& value) const {
+    size_t n = 0;
+    for (size_t i = find(value); i < length; i = find(value, i + 1)) {
+      ++n;
+    }
+    return n;
+  }
+
  private:
+  static const T* scan(const T* items, size_t count, const T& value) {
+    if constexpr (sizeof(T) == 1) {
+      int ch = *reinterpret_cast<const unsigned char*>(&value);
+      return static_cast<const T*>(memchr(items, ch, count));
+    } else {
+      for (; count; --count, ++items) {
+        if (*items == value) return items;
+      }
+      return nullptr;
+    }
+  }
+
   void grow(size_t extend) {
     if (!extend) return;
 
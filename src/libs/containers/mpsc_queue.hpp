@@ -0,0 +1,86 @@
+#pragma once
+#include <atomic>
+#include <concepts>
+
+#include "containers/cache_line.hpp"
+
+namespace ctr {
+
+/// Link embedded in everything that goes through an `MpscQueue`.
+struct MpscNode {
+  std::atomic<MpscNode*> next{nullptr};
+};
+
+/// Unbounded intrusive FIFO for any number of producers and one consumer (Vyukov's
+/// queue). Push is wait-free, a single exchange, so interrupt handlers on any cpu may
+/// push. Nodes are owned by the caller and must stay alive until popped, a node can only
+/// be in one queue at a time.
+///
+/// A producer stopped between its exchange and linking its node (preempted, or
+/// interrupted by the consumer on the same cpu) hides everything pushed after it: pop
+/// reports empty until that producer continues. Consumers that wait for items should
+/// therefore be woken by the producer, not spin.
+template <typename T>
+  requires std::derived_from<T, MpscNode>
+class MpscQueue {
+ public:
+  MpscQueue() = default;
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue(MpscQueue&&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+  MpscQueue& operator=(MpscQueue&&) = delete;
+
+  /// Any context, any cpu.
+  void push(T* item) noexcept { push_node(item); }
+
+  /// Consumer only. nullptr when empty.
+  T* pop() noexcept {
+    MpscNode* t = tail;
+    MpscNode* next = t->next.load(std::memory_order_acquire);
+
+    if (t == &stub) {
+      if (!next) return nullptr;
+      tail = next;
+      t = next;
+      next = next->next.load(std::memory_order_acquire);
+    }
+
+    if (next) {
+      tail = next;
+      return static_cast<T*>(t);
+    }
+
+    // `t` looks like the last node, unless a producer already swapped in a newer one
+    // and has not linked it yet
+    if (t != head.load(std::memory_order_acquire)) return nullptr;
+
+    // Put the stub behind the last node so it can be handed out
+    push_node(&stub);
+    next = t->next.load(std::memory_order_acquire);
+    if (next) {
+      tail = next;
+      return static_cast<T*>(t);
+    }
+    return nullptr;
+  }
+
+  /// Consumer only.
+  bool empty() const noexcept {
+    const MpscNode* t = tail;
+    if (t != &stub) return false;
+    return !t->next.load(std::memory_order_acquire);
+  }
+
+ private:
+  void push_node(MpscNode* node) noexcept {
+    node->next.store(nullptr, std::memory_order_relaxed);
+    MpscNode* prev = head.exchange(node, std::memory_order_acq_rel);
+    prev->next.store(node, std::memory_order_release);
+  }
+
+  alignas(CACHE_LINE_SIZE) std::atomic<MpscNode*> head{&stub};  // Producers
+  alignas(CACHE_LINE_SIZE) MpscNode* tail{&stub};               // Consumer only
+  MpscNode stub;
+};
+
+}  // namespace ctr
@@ -0,0 +1,79 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "containers/cache_line.hpp"
+
+namespace ctr {
+
+/// Bounded lock-free queue for exactly one producer and one consumer, e.g. an interrupt
+/// handler feeding a thread. Neither side ever waits or takes a lock. Producer and
+/// consumer indices live on separate cache lines, each side also keeps a cached copy of
+/// the other's index and only rereads it when the cached one says full/empty.
+template <typename T, size_t N>
+  requires(N >= 2 && (N & (N - 1)) == 0 && N <= (size_t{1} << 31) &&
+           std::is_default_constructible_v<T> && std::is_copy_assignable_v<T>)
+class SpscRing {
+ public:
+  SpscRing() = default;
+  SpscRing(const SpscRing&) = delete;
+  SpscRing(SpscRing&&) = delete;
+  SpscRing& operator=(const SpscRing&) = delete;
+  SpscRing& operator=(SpscRing&&) = delete;
+
+  /// Producer only. False when full, the value is dropped then.
+  bool try_push(const T& val) noexcept {
+    const uint32_t h = head.load(std::memory_order_relaxed);
+    if (h - tail_cache >= N) {
+      tail_cache = tail.load(std::memory_order_acquire);
+      if (h - tail_cache >= N) return false;
+    }
+
+    slots[h & Mask] = val;
+    head.store(h + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Consumer only. False when empty.
+  bool try_pop(T& out) noexcept {
+    const uint32_t t = tail.load(std::memory_order_relaxed);
+    if (t == head_cache) {
+      head_cache = head.load(std::memory_order_acquire);
+      if (t == head_cache) return false;
+    }
+
+    out = slots[t & Mask];
+    tail.store(t + 1, std::memory_order_release);
+    return true;
+  }
+
+  /// Exact for the consumer, a hint for everyone else.
+  inline bool empty() const noexcept {
+    return tail.load(std::memory_order_relaxed) == head.load(std::memory_order_acquire);
+  }
+
+  /// Exact for the producer, a hint for everyone else.
+  inline bool full() const noexcept { return count() >= N; }
+
+  inline size_t count() const noexcept {
+    return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+  }
+
+  static constexpr size_t capacity() noexcept { return N; }
+
+ private:
+  static constexpr uint32_t Mask = static_cast<uint32_t>(N - 1);
+
+  // Free running, wrap at 2^32, which N divides
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> head{0};
+  uint32_t tail_cache{0};  // Producer only
+
+  alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> tail{0};
+  uint32_t head_cache{0};  // Consumer only
+
+  alignas(CACHE_LINE_SIZE) T slots[N]{};
+};
+
+}  // namespace ctr
@@ -2,5 +2,6 @@ set(MODULE_NAME "math")
 
 set(MODULE_SOURCES
     "${CMAKE_CURRENT_LIST_DIR}/bit_logic.cpp"
+    "${CMAKE_CURRENT_LIST_DIR}/int_format.cpp"
 )
 
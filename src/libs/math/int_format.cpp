@@ -0,0 +1,159 @@
+#include "math/int_format.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+namespace {
+
+constexpr char lower_digits[] = "0123456789abcdef";
+constexpr char upper_digits[] = "0123456789ABCDEF";
+
+constexpr char digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+/// High 64 bits of a 64x64 multiplication, out of 32x32->64 multiplies only.
+inline uint64_t mul_high(uint64_t a, uint64_t b) noexcept {
+  const uint64_t a_lo = static_cast<uint32_t>(a), a_hi = a >> 32;
+  const uint64_t b_lo = static_cast<uint32_t>(b), b_hi = b >> 32;
+
+  const uint64_t lo_lo = a_lo * b_lo;
+  const uint64_t hi_lo = a_hi * b_lo;
+  const uint64_t lo_hi = a_lo * b_hi;
+  const uint64_t hi_hi = a_hi * b_hi;
+
+  const uint64_t cross = (lo_lo >> 32) + static_cast<uint32_t>(hi_lo) + lo_hi;
+  return hi_hi + (hi_lo >> 32) + (cross >> 32);
+}
+
+/// value / 10^9. 10^9 = 2^9 * 5^9, after dropping the 2^9 the numerator has at most
+/// 55 bits, which keeps the rounded up reciprocal exact for every input.
+inline uint64_t div_1e9(uint64_t value) noexcept {
+  constexpr uint64_t Reciprocal = 0x44b82fa09b5a53;  // ceil(2^75 / 5^9)
+  return mul_high(value >> 9, Reciprocal) >> 11;
+}
+
+inline char* put_pair(char* end, uint32_t pair) noexcept {
+  end -= 2;
+  end[0] = digit_pairs[pair * 2];
+  end[1] = digit_pairs[pair * 2 + 1];
+  return end;
+}
+
+char* format_dec32(uint32_t value, char* end) noexcept {
+  while (value >= 100) {
+    end = put_pair(end, value % 100);
+    value /= 100;
+  }
+
+  if (value >= 10) return put_pair(end, value);
+  *--end = static_cast<char>('0' + value);
+  return end;
+}
+
+/// Exactly nine digits, leading zeros included.
+char* format_dec9(uint32_t value, char* end) noexcept {
+  for (int i = 0; i < 4; ++i) {
+    end = put_pair(end, value % 100);
+    value /= 100;
+  }
+  *--end = static_cast<char>('0' + value);
+  return end;
+}
+
+char* format_pow2(uint64_t value, uint32_t shift, const char* digits,
+                  char* end) noexcept {
+  const uint32_t mask = (1u << shift) - 1;
+
+  // Stay on 64 bit shifts only until the rest fits a single register
+  while (value > UINT32_MAX) {
+    *--end = digits[static_cast<uint32_t>(value) & mask];
+    value >>= shift;
+  }
+
+  uint32_t v = static_cast<uint32_t>(value);
+  do {
+    *--end = digits[v & mask];
+    v >>= shift;
+  } while (v);
+
+  return end;
+}
+
+/// value / divisor for a divisor below 2^16, one 16 bit limb at a time so that every
+/// step is a 32 bit division.
+inline uint64_t div_small(uint64_t value, uint32_t divisor, uint32_t& rem) noexcept {
+  uint64_t q = 0;
+  uint32_t r = 0;
+  for (int shift = 48; shift >= 0; shift -= 16) {
+    const uint32_t cur = (r << 16) | (static_cast<uint32_t>(value >> shift) & 0xFFFF);
+    q = (q << 16) | cur / divisor;
+    r = cur % divisor;
+  }
+  rem = r;
+  return q;
+}
+
+char* format_generic(uint64_t value, uint32_t base, const char* digits,
+                     char* end) noexcept {
+  // Only odd bases end up here. Above 32 bit each long division takes off as many digits
+  // as the largest power of the base below 2^16 holds.
+  uint32_t chunk = base;
+  uint32_t chunk_digits = 1;
+  while (chunk * base <= 0xFFFF) {
+    chunk *= base;
+    ++chunk_digits;
+  }
+
+  while (value > UINT32_MAX) {
+    uint32_t rem;
+    value = div_small(value, chunk, rem);
+    for (uint32_t i = 0; i < chunk_digits; ++i) {
+      *--end = digits[rem % base];
+      rem /= base;
+    }
+  }
+
+  uint32_t v = static_cast<uint32_t>(value);
+  do {
+    *--end = digits[v % base];
+    v /= base;
+  } while (v);
+
+  return end;
+}
+
+}  // namespace
+
+char* format_uint(uint64_t value, uint32_t base, bool uppercase, char* end) noexcept {
+  if (base < 2 || base > 16) return end;
+
+  const char* digits = uppercase ? upper_digits : lower_digits;
+
+  if (base == 10) {
+    while (value > UINT32_MAX) {
+      const uint64_t q = div_1e9(value);
+      end = format_dec9(static_cast<uint32_t>(value - q * 1000000000u), end);
+      value = q;
+    }
+    return format_dec32(static_cast<uint32_t>(value), end);
+  }
+
+  if ((base & (base - 1)) == 0) {
+    return format_pow2(value, static_cast<uint32_t>(__builtin_ctz(base)), digits, end);
+  }
+
+  return format_generic(value, base, digits, end);
+}
+
+}  // namespace math
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace math {
+
+/// Enough room for any uint64_t in any base from 2 to 16.
+inline constexpr size_t MAX_INT_DIGITS = 64;
+
+/// Write the digits of `value` in `base` (2 to 16) right aligned so that the last digit
+/// lands at `end - 1`. Returns a pointer to the first digit, `end` for invalid bases.
+///
+/// Never divides a 64 bit number: values that fit 32 bit take a 32 bit path, decimal is
+/// produced two digits at a time from a lookup table and peeled off in 9 digit chunks
+/// via reciprocal multiplication, power of two bases are shift and mask. Other bases
+/// long divide by a power of the base in 16 bit limbs.
+char* format_uint(uint64_t value, uint32_t base, bool uppercase, char* end) noexcept;
+
+}  // namespace math
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+
+namespace math {
+
+/// Rate conversion as `(v * mult) >> shift`, so converting e.g. cycles to nanoseconds
+/// costs two 32x32 multiplies instead of a 64 bit division.
+struct Scale {
+  uint32_t mult{0};
+  uint32_t shift{0};
+
+  /// Maps counts at rate `from` to counts at rate `to`, both in the same unit. Picks the
+  /// largest shift whose mult still fits in 32 bits for the best precision.
+  static constexpr Scale between(uint32_t from, uint32_t to) noexcept {
+    if (!from) return {};
+
+    for (uint32_t shift = 32; shift > 0; --shift) {
+      const uint64_t mult = ((uint64_t{to} << shift) + from / 2) / from;
+      if (mult <= UINT32_MAX) return {static_cast<uint32_t>(mult), shift};
+    }
+    return {to / from, 0};
+  }
+
+  /// Exact for the whole 64 bit range of `v` as long as the result fits.
+  constexpr uint64_t apply(uint64_t v) const noexcept {
+    const uint64_t hi = (v >> 32) * mult;
+    const uint64_t lo = (v & UINT32_MAX) * mult;
+    return (hi << (32 - shift)) + (lo >> shift);
+  }
+};
+
+}  // namespace math
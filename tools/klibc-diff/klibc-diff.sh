@@ -0,0 +1,70 @@
+#!/usr/bin/env bash
+set -euo pipefail
+
+# klibc-diff.sh — Build klibc for the host and check it against glibc.
+#
+# klibc and the arch specific memory routines are compiled freestanding with the
+# host compiler, every symbol is prefixed with `klibc_` and the result is linked
+# into a normal hosted driver that fuzzes each routine against glibc and reports
+# throughput per size bucket.
+#
+# Usage:
+#   tools/klibc-diff/klibc-diff.sh [driver args]
+#
+# Driver args:
+#   --variant <generic|erms|sse2|avx>   -> only check one memory routine table
+#   --seed <N>                          -> random seed
+#   --no-bench                          -> conformance only
+#   --quick                             -> fewer lengths and formats
+#
+# Environment:
+#   CXX       -> host compiler (default g++)
+#   BUILD_DIR -> output directory (default build/klibc-diff)
+
+here="$(cd "$(dirname "$0")" && pwd)"
+root="$(cd "$here/../.." && pwd)"
+compiler="${CXX:-g++}"
+out="${BUILD_DIR:-$root/build/klibc-diff}"
+
+command -v "$compiler" >/dev/null 2>&1 || { echo "error: compiler '$compiler' not found in PATH" >&2; exit 1; }
+mkdir -p "$out"
+
+# Same language settings as the kernel build, minus anything target specific.
+# No PIC so no GOT references need to survive the symbol prefixing.
+KLIBC_FLAGS=(
+  -std=c++20 -O2 -Wall -Wextra
+  -ffreestanding -fno-exceptions -fno-rtti -fno-builtin
+  -fno-stack-protector -fno-pic -fno-asynchronous-unwind-tables
+  -I "$root/src/kernel/modules/klibc/include"
+  -I "$root/src/kernel/modules/klibc/src"
+  -I "$root/src/kernel"
+  -I "$root/src/arch"
+  -I "$root/src/libs"
+)
+
+KLIBC_SOURCES=(
+  "$root/src/kernel/modules/klibc/src/string.cpp"
+  "$root/src/kernel/modules/klibc/src/vsnprintf.cpp"
+  "$root/src/libs/math/int_format.cpp"
+  "$root/src/arch/x86/common/simd/mem_ops.cpp"
+  "$here/shim.cpp"
+)
+
+objs=()
+for src in "${KLIBC_SOURCES[@]}"; do
+  obj="$out/$(basename "${src%.cpp}").o"
+  echo ">> CXX  $src"
+  "$compiler" "${KLIBC_FLAGS[@]}" -c "$src" -o "$obj"
+  objs+=("$obj")
+done
+
+echo ">> LD   klibc.o"
+ld -r -o "$out/klibc.o" "${objs[@]}"
+objcopy --prefix-symbols=klibc_ "$out/klibc.o" "$out/klibc-prefixed.o"
+
+echo ">> CXX  $here/main.cpp"
+"$compiler" -std=c++20 -O2 -Wall -Wextra -no-pie \
+  "$here/main.cpp" "$out/klibc-prefixed.o" -o "$out/klibc-diff"
+
+echo ">> Running $out/klibc-diff $*"
+"$out/klibc-diff" "$@"
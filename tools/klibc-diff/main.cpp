@@ -0,0 +1,547 @@
+// Host driver for the klibc differential suite. klibc is linked in with every symbol
+// prefixed by `klibc_`, so both implementations can live in one process and every
+// klibc result is checked against the glibc one.
+#include <cpuid.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+extern "C" {
+void* klibc_memcpy(void* dest, const void* src, size_t count);
+void* klibc_memset(void* dest, int ch, size_t count);
+void* klibc_memmove(void* dest, const void* src, size_t count);
+int klibc_memcmp(const void* lhs, const void* rhs, size_t count);
+int klibc_strncmp(const char* lhs, const char* rhs, size_t count);
+size_t klibc_strlen(const char* str);
+void* klibc_memchr(const void* ptr, int ch, size_t count);
+void* klibc_memrchr(const void* ptr, int ch, size_t count);
+char* klibc_strchr(const char* str, int ch);
+int klibc_vsnprintf(char* buf, size_t size, const char* fmt, va_list ap);
+
+bool klibc_diff_select_ops(const char* name);
+const char* klibc_diff_active_ops();
+void klibc_diff_fill32(uint32_t* dest, uint32_t val, size_t count);
+}
+
+namespace {
+
+constexpr size_t MaxLen = 4096;
+constexpr size_t MaxAlign = 64;
+constexpr size_t Guard = 64;
+constexpr size_t ArenaSize = Guard + MaxAlign + MaxLen + MaxAlign + Guard;
+constexpr uint8_t Poison = 0xA5;
+
+std::mt19937 rng{0x6b6c6962};
+size_t failures = 0;
+
+#define EXPECT(cond, ...)                                \
+  do {                                                   \
+    if (!(cond)) {                                       \
+      if (failures++ < 20) {                             \
+        std::printf("FAIL %s:%d: ", __func__, __LINE__); \
+        std::printf(__VA_ARGS__);                        \
+        std::printf("\n");                               \
+      }                                                  \
+    }                                                    \
+  } while (0)
+
+int sign(int v) {
+  return (v > 0) - (v < 0);
+}
+
+uint8_t random_byte() {
+  // Bias towards a small alphabet so searches and compares hit often, but keep
+  // bytes >= 0x80 around to catch signedness bugs.
+  switch (rng() % 8) {
+    case 0: return static_cast<uint8_t>(rng());
+    case 1: return 0x80 + rng() % 0x80;
+    default: return 'a' + rng() % 4;
+  }
+}
+
+void fill_random(uint8_t* p, size_t n) {
+  for (size_t i = 0; i < n; ++i) {
+    p[i] = random_byte();
+  }
+}
+
+/// Every length up to 256 and a spread of lengths above, up to MaxLen.
+std::vector<size_t> test_lengths() {
+  std::vector<size_t> lengths;
+  for (size_t n = 0; n <= 256; ++n) {
+    lengths.push_back(n);
+  }
+  for (size_t p = 512; p <= MaxLen; p *= 2) {
+    lengths.push_back(p - 1);
+    lengths.push_back(p);
+    if (p < MaxLen) lengths.push_back(p + 1);
+  }
+  for (int i = 0; i < 48; ++i) {
+    lengths.push_back(257 + rng() % (MaxLen - 257));
+  }
+  return lengths;
+}
+
+/// All alignment pairs for short lengths, a sample of them for long ones.
+template <typename Fn>
+void for_alignments(size_t len, Fn&& fn) {
+  const size_t step = len <= 256 ? 1 : 16;
+  for (size_t a = 0; a < MaxAlign; ++a) {
+    for (size_t b = (a % step); b < MaxAlign; b += step) {
+      fn(a, b);
+    }
+  }
+}
+
+bool guards_intact(const uint8_t* arena, size_t begin, size_t end) {
+  for (size_t i = 0; i < begin; ++i) {
+    if (arena[i] != Poison) return false;
+  }
+  for (size_t i = end; i < ArenaSize; ++i) {
+    if (arena[i] != Poison) return false;
+  }
+  return true;
+}
+
+void check_memcpy(const std::vector<size_t>& lengths) {
+  static uint8_t src[ArenaSize], dst[ArenaSize];
+  fill_random(src, ArenaSize);
+
+  for (size_t len : lengths) {
+    for_alignments(len, [&](size_t da, size_t sa) {
+      std::memset(dst, Poison, ArenaSize);
+      uint8_t* d = dst + Guard + da;
+      const uint8_t* s = src + Guard + sa;
+
+      void* ret = klibc_memcpy(d, s, len);
+      EXPECT(ret == d, "len=%zu da=%zu sa=%zu returned wrong pointer", len, da, sa);
+      EXPECT(std::memcmp(d, s, len) == 0, "len=%zu da=%zu sa=%zu mismatch", len, da, sa);
+      EXPECT(guards_intact(dst, Guard + da, Guard + da + len),
+             "len=%zu da=%zu sa=%zu wrote out of bounds", len, da, sa);
+    });
+  }
+}
+
+void check_memset(const std::vector<size_t>& lengths) {
+  static uint8_t dst[ArenaSize], ref[ArenaSize];
+
+  for (size_t len : lengths) {
+    for (size_t da = 0; da < MaxAlign; ++da) {
+      // Values above 0xFF make sure only the low byte is used
+      int ch = static_cast<int>(rng() % 0x300) - 0x100;
+      std::memset(dst, Poison, ArenaSize);
+      std::memset(ref, Poison, ArenaSize);
+      uint8_t* d = dst + Guard + da;
+
+      void* ret = klibc_memset(d, ch, len);
+      std::memset(ref + Guard + da, ch, len);
+      EXPECT(ret == d, "len=%zu da=%zu returned wrong pointer", len, da);
+      EXPECT(std::memcmp(dst, ref, ArenaSize) == 0, "len=%zu da=%zu ch=%d mismatch", len,
+             da, ch);
+    }
+  }
+}
+
+void check_fill32(const std::vector<size_t>& lengths) {
+  static uint32_t dst[ArenaSize], ref[ArenaSize];
+
+  for (size_t len : lengths) {
+    for (size_t da = 0; da < 16; ++da) {
+      uint32_t val = static_cast<uint32_t>(rng());
+      std::fill(dst, dst + ArenaSize, 0xA5A5A5A5u);
+      std::fill(ref, ref + ArenaSize, 0xA5A5A5A5u);
+
+      klibc_diff_fill32(dst + Guard + da, val, len);
+      std::fill(ref + Guard + da, ref + Guard + da + len, val);
+      EXPECT(std::memcmp(dst, ref, sizeof(dst)) == 0, "len=%zu da=%zu mismatch", len, da);
+    }
+  }
+}
+
+void check_memmove(const std::vector<size_t>& lengths) {
+  static uint8_t orig[ArenaSize * 2], buf[ArenaSize * 2], ref[ArenaSize * 2];
+  fill_random(orig, sizeof(orig));
+  std::memcpy(buf, orig, sizeof(orig));
+  std::memcpy(ref, orig, sizeof(orig));
+
+  for (size_t len : lengths) {
+    // Offsets within [0, 2 * MaxAlign) of each other give forward, backward and exact
+    // overlaps as well as disjoint copies for short lengths.
+    for_alignments(len, [&](size_t da, size_t sa) {
+      for (size_t shift : {size_t{0}, MaxAlign}) {
+        size_t doff = Guard + da + shift;
+        size_t soff = Guard + sa + (MaxAlign - shift);
+
+        void* ret = klibc_memmove(buf + doff, buf + soff, len);
+        std::memmove(ref + doff, ref + soff, len);
+        EXPECT(ret == buf + doff, "len=%zu doff=%zu soff=%zu returned wrong pointer", len,
+               doff, soff);
+        size_t lo = std::min(doff, soff) - Guard;
+        size_t hi = std::max(doff, soff) + len + Guard;
+        EXPECT(std::memcmp(buf + lo, ref + lo, hi - lo) == 0, "len=%zu doff=%zu soff=%zu",
+               len, doff, soff);
+
+        // Only the touched window has to be restored for the next round
+        std::memcpy(buf + doff, orig + doff, len);
+        std::memcpy(ref + doff, orig + doff, len);
+      }
+    });
+  }
+}
+
+void check_compare(const std::vector<size_t>& lengths) {
+  static uint8_t lhs[ArenaSize], rhs[ArenaSize];
+
+  for (size_t len : lengths) {
+    for_alignments(len, [&](size_t la, size_t ra) {
+      uint8_t* l = lhs + Guard + la;
+      uint8_t* r = rhs + Guard + ra;
+      fill_random(l, len + 8);
+      std::memcpy(r, l, len + 8);
+
+      // Differ at a random position, or not at all
+      if (len && rng() % 4) {
+        size_t at = rng() % len;
+        r[at] = random_byte();
+      }
+
+      // Sprinkle a few terminators for strncmp
+      if (rng() % 2) {
+        for (int i = 0; i < 2; ++i) {
+          size_t at = rng() % (len + 8);
+          l[at] = r[at] = 0;
+        }
+      }
+
+      int want = sign(std::memcmp(l, r, len));
+      int got = sign(klibc_memcmp(l, r, len));
+      EXPECT(got == want, "memcmp len=%zu la=%zu ra=%zu got %d want %d", len, la, ra, got,
+             want);
+
+      auto* ls = reinterpret_cast<const char*>(l);
+      auto* rs = reinterpret_cast<const char*>(r);
+      want = sign(std::strncmp(ls, rs, len));
+      got = sign(klibc_strncmp(ls, rs, len));
+      EXPECT(got == want, "strncmp len=%zu la=%zu ra=%zu got %d want %d", len, la, ra,
+             got, want);
+    });
+  }
+}
+
+void check_search(const std::vector<size_t>& lengths) {
+  static uint8_t buf[ArenaSize];
+
+  for (size_t len : lengths) {
+    for (size_t a = 0; a < MaxAlign; ++a) {
+      uint8_t* p = buf + Guard + a;
+      fill_random(buf, ArenaSize);
+      for (size_t i = 0; i < len; ++i) {
+        if (!p[i]) p[i] = 'z';
+      }
+      p[len] = 0;
+
+      int ch = rng() % 8 ? random_byte() : 0;
+      auto* s = reinterpret_cast<char*>(p);
+
+      EXPECT(klibc_strlen(s) == std::strlen(s), "strlen len=%zu a=%zu", len, a);
+      EXPECT(klibc_memchr(p, ch, len) == std::memchr(p, ch, len),
+             "memchr len=%zu a=%zu ch=%d", len, a, ch);
+      EXPECT(klibc_memrchr(p, ch, len) == ::memrchr(p, ch, len),
+             "memrchr len=%zu a=%zu ch=%d", len, a, ch);
+      EXPECT(klibc_strchr(s, ch) == std::strchr(s, ch), "strchr len=%zu a=%zu ch=%d", len,
+             a, ch);
+    }
+  }
+}
+
+int klibc_snprintf(char* buf, size_t size, const char* fmt, ...) {
+  va_list ap;
+  va_start(ap, fmt);
+  int ret = klibc_vsnprintf(buf, size, fmt, ap);
+  va_end(ap);
+  return ret;
+}
+
+/// Random conversion spec within the subset klibc documents: flags, width (also `*`),
+/// l/ll length modifiers and d i u x X o c s %. Precision is parsed but ignored by
+/// klibc, so it is left out.
+struct Spec {
+  std::string fmt;
+  char conv;
+  int star_width;
+  bool is_long_long;
+  bool is_long;
+};
+
+Spec random_spec() {
+  static constexpr char convs[] = "diuxXocs%";
+  Spec s{};
+  s.conv = convs[rng() % (sizeof(convs) - 1)];
+  s.fmt.push_back('%');
+  if (s.conv == '%') return s;
+
+  const bool is_int = s.conv != 'c' && s.conv != 's';
+  for (char f : std::string("-0+ #")) {
+    if (rng() % 4) continue;
+    // Combinations the C standard leaves undefined
+    if ((f == '0' || f == '#' || f == '+' || f == ' ') && !is_int) continue;
+    if (f == '#' && s.conv != 'x' && s.conv != 'X' && s.conv != 'o') continue;
+    s.fmt += f;
+  }
+
+  switch (rng() % 3) {
+    case 0: break;
+    case 1: s.fmt += std::to_string(1 + rng() % 24); break;
+    case 2:
+      s.fmt += '*';
+      s.star_width = static_cast<int>(rng() % 49) - 24;
+      break;
+  }
+
+  if (is_int) {
+    switch (rng() % 3) {
+      case 0: break;
+      case 1: s.fmt += 'l'; s.is_long = true; break;
+      case 2: s.fmt += "ll"; s.is_long_long = true; break;
+    }
+  }
+
+  s.fmt += s.conv;
+  return s;
+}
+
+int64_t random_int() {
+  switch (rng() % 4) {
+    case 0: return static_cast<int64_t>(rng() % 20) - 10;
+    case 1: return static_cast<int32_t>(rng());
+    case 2: return static_cast<int64_t>((uint64_t{rng()} << 32) | rng());
+    default: return rng() % 2 ? INT64_MIN : INT64_MAX;
+  }
+}
+
+template <typename Fn>
+int call_with_args(const Spec& spec, int64_t value, const char* str, Fn&& fn) {
+  const bool star = spec.fmt.find('*') != std::string::npos;
+  auto with = [&](auto arg) {
+    return star ? fn(spec.star_width, arg) : fn(arg);
+  };
+
+  switch (spec.conv) {
+    case '%': return fn();
+    case 's': return with(str);
+    case 'c': return with(static_cast<int>(static_cast<uint8_t>(value)));
+  }
+  if (spec.is_long_long) return with(static_cast<long long>(value));
+  if (spec.is_long) return with(static_cast<long>(value));
+  return with(static_cast<int>(value));
+}
+
+void check_vsnprintf(size_t iterations) {
+  static const char* strings[] = {"", "a", "klibc", "a somewhat longer string", nullptr};
+
+  for (size_t it = 0; it < iterations; ++it) {
+    // Up to three conversions with literal text in between
+    Spec specs[3];
+    int64_t values[3];
+    const char* strs[3];
+    std::string fmt = "<";
+    const size_t count = 1 + rng() % 3;
+    for (size_t i = 0; i < count; ++i) {
+      specs[i] = random_spec();
+      values[i] = random_int();
+      strs[i] = strings[rng() % (sizeof(strings) / sizeof(*strings))];
+      fmt += specs[i].fmt + "|";
+    }
+
+    // Each conversion is also checked alone, so mismatches are easy to pin down
+    for (size_t i = 0; i < count; ++i) {
+      char want[256], got[256];
+      const Spec& s = specs[i];
+      int want_ret = call_with_args(s, values[i], strs[i], [&](auto... args) {
+        return std::snprintf(want, sizeof(want), s.fmt.c_str(), args...);
+      });
+      // glibc prints "(null)" as well, but passing nullptr is undefined for it
+      if (s.conv == 's' && !strs[i]) {
+        want_ret = call_with_args(s, values[i], "(null)", [&](auto... args) {
+          return std::snprintf(want, sizeof(want), s.fmt.c_str(), args...);
+        });
+      }
+
+      // Every truncation point of the output, including a zero sized buffer
+      for (size_t size = 0; size <= static_cast<size_t>(want_ret) + 1; ++size) {
+        std::memset(got, Poison, sizeof(got));
+        int got_ret = call_with_args(s, values[i], strs[i], [&](auto... args) {
+          return klibc_snprintf(size ? got : nullptr, size, s.fmt.c_str(), args...);
+        });
+
+        bool ok = got_ret == want_ret;
+        if (size) {
+          size_t n = std::min(size - 1, static_cast<size_t>(want_ret));
+          ok = ok && std::memcmp(got, want, n) == 0 && got[n] == '\0';
+        }
+        EXPECT(ok, "fmt=\"%s\" value=%lld size=%zu got %d \"%s\" want %d \"%s\"",
+               s.fmt.c_str(), static_cast<long long>(values[i]), size, got_ret,
+               size ? std::string(got, strnlen(got, size)).c_str() : "", want_ret, want);
+        if (!ok) break;
+      }
+    }
+  }
+}
+
+/// Nanoseconds per call, best of a few runs to keep scheduler noise out.
+template <typename Fn>
+double time_per_call(size_t len, Fn&& fn) {
+  const size_t iters =
+      std::max<size_t>(64, (size_t{64} << 20) / std::max<size_t>(len, 16));
+  double best = 1e30;
+  for (int run = 0; run < 5; ++run) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < iters; ++i) {
+      fn();
+      asm volatile("" ::: "memory");
+    }
+    std::chrono::duration<double, std::nano> dt =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, dt.count() / static_cast<double>(iters));
+  }
+  return best;
+}
+
+void report(const char* name, size_t len, double klibc_ns, double glibc_ns) {
+  auto gbps = [&](double ns) { return static_cast<double>(len) / ns; };
+  std::printf("  %-8s %7zu %10.2f %10.2f %9.2fx\n", name, len, gbps(klibc_ns),
+              gbps(glibc_ns), glibc_ns / klibc_ns);
+}
+
+void bench() {
+  static constexpr size_t buckets[] = {16, 64, 256, 1024, 4096, 16384, 65536};
+  constexpr size_t Max = 65536 + 64;
+  std::vector<uint8_t> src(Max), dst(Max);
+  fill_random(src.data(), Max);
+  for (auto& b : src) {
+    if (!b) b = 'z';
+  }
+  src[Max - 1] = 0;
+
+  // Results are fed back through volatile sinks so nothing gets optimised away
+  volatile size_t sink = 0;
+  uint8_t* d = dst.data() + 1;
+  const uint8_t* s = src.data() + 3;
+
+  std::printf("  %-8s %7s %10s %10s %10s\n", "op", "bytes", "klibc GB/s", "glibc GB/s",
+              "ratio");
+  for (size_t len : buckets) {
+    report("memcpy", len, time_per_call(len, [&] { klibc_memcpy(d, s, len); }),
+           time_per_call(len, [&] { std::memcpy(d, s, len); }));
+    report("memset", len, time_per_call(len, [&] { klibc_memset(d, 0x5a, len); }),
+           time_per_call(len, [&] { std::memset(d, 0x5a, len); }));
+    report("memmove", len, time_per_call(len, [&] { klibc_memmove(d + 8, d, len); }),
+           time_per_call(len, [&] { std::memmove(d + 8, d, len); }));
+
+    std::memcpy(d, s, len);
+    report("memcmp", len, time_per_call(len, [&] { sink = klibc_memcmp(d, s, len); }),
+           time_per_call(len, [&] { sink = std::memcmp(d, s, len); }));
+
+    char* str = reinterpret_cast<char*>(d);
+    std::memset(d, 'a', len);
+    d[len] = 0;
+    report("strlen", len, time_per_call(len, [&] { sink = klibc_strlen(str); }),
+           time_per_call(len, [&] { sink = std::strlen(str); }));
+    report("memchr", len,
+           time_per_call(len, [&] { sink = klibc_memchr(d, 'z', len) != nullptr; }),
+           time_per_call(len, [&] { sink = std::memchr(d, 'z', len) != nullptr; }));
+  }
+  (void)sink;
+}
+
+bool cpu_has_erms() {
+  unsigned a, b, c, d;
+  if (!__get_cpuid_count(7, 0, &a, &b, &c, &d)) return false;
+  return (b >> 9) & 1;
+}
+
+bool cpu_supports(const std::string& variant) {
+  if (variant == "generic") return true;
+  if (variant == "erms") return cpu_has_erms();
+  if (variant == "sse2") return __builtin_cpu_supports("sse2");
+  if (variant == "avx") return __builtin_cpu_supports("avx");
+  return false;
+}
+
+void usage(const char* argv0) {
+  std::printf(
+      "usage: %s [--variant generic|erms|sse2|avx] [--seed N] [--no-bench] [--quick]\n"
+      "Without --variant every variant the host cpu supports is checked.\n",
+      argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::vector<std::string> variants = {"generic", "erms", "sse2", "avx"};
+  bool run_bench = true;
+  bool quick = false;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--variant" && i + 1 < argc) {
+      variants = {argv[++i]};
+    } else if (arg == "--seed" && i + 1 < argc) {
+      rng.seed(static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0)));
+    } else if (arg == "--no-bench") {
+      run_bench = false;
+    } else if (arg == "--quick") {
+      quick = true;
+    } else {
+      usage(argv[0]);
+      return arg == "-h" || arg == "--help" ? 0 : 2;
+    }
+  }
+
+  std::vector<size_t> lengths = test_lengths();
+  if (quick) {
+    lengths.erase(std::remove_if(lengths.begin(), lengths.end(),
+                                 [](size_t n) { return n > 64 && n % 61 != 0; }),
+                  lengths.end());
+  }
+
+  std::printf("== variant independent\n");
+  size_t before = failures;
+  check_compare(lengths);
+  check_vsnprintf(quick ? 2000 : 20000);
+  std::printf("  memcmp/strncmp/vsnprintf: %s\n", failures == before ? "ok" : "FAILED");
+
+  for (const auto& v : variants) {
+    if (!cpu_supports(v) || !klibc_diff_select_ops(v.c_str())) {
+      std::printf("== %s: skipped, not supported here\n", v.c_str());
+      continue;
+    }
+
+    std::printf("== %s (active: %s)\n", v.c_str(), klibc_diff_active_ops());
+    before = failures;
+    check_memcpy(lengths);
+    check_memset(lengths);
+    check_fill32(lengths);
+    check_memmove(lengths);
+    check_search(lengths);
+    std::printf("  memcpy/memset/fill32/memmove/strlen/memchr/memrchr/strchr: %s\n",
+                failures == before ? "ok" : "FAILED");
+
+    if (run_bench) bench();
+  }
+
+  if (failures) {
+    std::printf("%zu check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,61 @@
+// Compiled together with klibc and then symbol prefixed, so it only ever sees klibc's
+// view of the world. Gives the host driver a C entry point for switching variants.
+#include <cstddef>
+#include <cstdint>
+#include <string.h>
+
+#include <kernel/mem_ops.hpp>
+
+#include "hal/cpu_features.hpp"
+#include "x86/common/simd/mem_ops.hpp"
+
+// Features is Loggable, so its vtable drags these in. Nothing here ever logs or
+// deletes one.
+namespace logging::format {
+void sink_write(const char*, size_t) noexcept {}
+}  // namespace logging::format
+
+void operator delete(void*) noexcept {}
+void operator delete(void*, size_t) noexcept {}
+
+namespace {
+
+struct Variant {
+  const char* name;
+  hal::cpu::Feature flags;
+};
+
+const Variant variants[] = {
+    {"avx", hal::cpu::Feature::Avx | hal::cpu::Feature::Sse2},
+    {"sse2", hal::cpu::Feature::Sse2},
+    {"erms", hal::cpu::Feature::Erms},
+};
+
+}  // namespace
+
+extern "C" {
+
+bool diff_select_ops(const char* name) {
+  klibc::set_mem_ops(klibc::generic_mem_ops());
+  if (strncmp(name, "generic", 8) == 0) return true;
+
+  for (const auto& v : variants) {
+    if (strncmp(name, v.name, strlen(v.name) + 1) != 0) continue;
+
+    hal::cpu::Features f{};
+    f.flags = v.flags;
+    x86::simd::install_mem_ops(f);
+    return true;
+  }
+
+  return false;
+}
+
+const char* diff_active_ops() {
+  return klibc::mem_ops().name;
+}
+
+void diff_fill32(uint32_t* dest, uint32_t val, size_t count) {
+  klibc::fill32(dest, val, count);
+}
+}
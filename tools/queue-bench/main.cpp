@@ -0,0 +1,281 @@
+// Host driver for the lock-free queues in libs/containers. Producers tag each item with
+// their index and a sequence number, the single consumer checks every producer's
+// sequence arrives complete and in order.
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "containers/mpsc_queue.hpp"
+#include "containers/spsc_ring.hpp"
+
+namespace {
+
+struct Item {
+  uint32_t producer;
+  uint32_t seq;
+};
+
+struct Node : ctr::MpscNode {
+  Item item;
+};
+
+size_t failures = 0;
+
+#define EXPECT(cond, ...)                                \
+  do {                                                   \
+    if (!(cond)) {                                       \
+      if (failures++ < 20) {                             \
+        std::printf("FAIL %s:%d: ", __func__, __LINE__); \
+        std::printf(__VA_ARGS__);                        \
+        std::printf("\n");                               \
+      }                                                  \
+    }                                                    \
+  } while (0)
+
+/// Spin a little, then give the cpu away. Keeps single core hosts from crawling while
+/// the other side is descheduled.
+void backoff(uint32_t& spins) {
+  if (++spins < 64) return;
+  spins = 0;
+  std::this_thread::yield();
+}
+
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point start) {
+  return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const char* name, uint32_t producers, uint64_t items, double secs) {
+  std::printf("  %-20s %2u producer(s) %10.2f Mitems/s %8.1f ns/item\n", name, producers,
+              items / secs / 1e6, secs * 1e9 / items);
+}
+
+/// Checks the per-producer order of everything the consumer saw.
+class OrderCheck {
+ public:
+  explicit OrderCheck(uint32_t producers) : next(producers, 0) {}
+
+  void saw(const Item& item) {
+    EXPECT(item.producer < next.size(), "bad producer %u", item.producer);
+    if (item.producer >= next.size()) return;
+    EXPECT(item.seq == next[item.producer], "producer %u: got seq %u, expected %u",
+           item.producer, item.seq, next[item.producer]);
+    next[item.producer] = item.seq + 1;
+  }
+
+  void finish(uint32_t items) {
+    for (uint32_t p = 0; p < next.size(); ++p) {
+      EXPECT(next[p] == items, "producer %u: %u of %u items arrived", p, next[p], items);
+    }
+  }
+
+ private:
+  std::vector<uint32_t> next;
+};
+
+void bench_spsc(uint32_t items) {
+  static ctr::SpscRing<Item, 1024> ring;
+  OrderCheck check{1};
+
+  const auto start = Clock::now();
+  std::thread producer([items] {
+    uint32_t spins = 0;
+    for (uint32_t seq = 0; seq < items; ++seq) {
+      while (!ring.try_push(Item{0, seq})) {
+        backoff(spins);
+      }
+    }
+  });
+
+  uint32_t spins = 0;
+  for (uint32_t got = 0; got < items;) {
+    Item item;
+    if (ring.try_pop(item)) {
+      check.saw(item);
+      ++got;
+    } else {
+      backoff(spins);
+    }
+  }
+  producer.join();
+  const double secs = seconds_since(start);
+
+  check.finish(items);
+  EXPECT(ring.empty(), "ring not empty after draining");
+  report("SpscRing<1024>", 1, items, secs);
+}
+
+void bench_mpsc(uint32_t producers, uint32_t items) {
+  static ctr::MpscQueue<Node> queue;
+  // Preallocated, the queue is intrusive and allocation would dominate the numbers
+  std::vector<Node> nodes(size_t{producers} * items);
+  OrderCheck check{producers};
+
+  std::atomic<bool> go{false};
+  std::vector<std::thread> threads;
+  for (uint32_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      while (!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+      Node* mine = &nodes[size_t{p} * items];
+      for (uint32_t seq = 0; seq < items; ++seq) {
+        mine[seq].item = Item{p, seq};
+        queue.push(&mine[seq]);
+      }
+    });
+  }
+
+  const auto start = Clock::now();
+  go.store(true, std::memory_order_release);
+
+  const uint64_t total = uint64_t{producers} * items;
+  uint32_t spins = 0;
+  for (uint64_t got = 0; got < total;) {
+    if (Node* n = queue.pop()) {
+      check.saw(n->item);
+      ++got;
+    } else {
+      backoff(spins);
+    }
+  }
+  const double secs = seconds_since(start);
+  for (auto& t : threads) t.join();
+
+  check.finish(items);
+  EXPECT(queue.empty() && !queue.pop(), "queue not empty after draining");
+  report("MpscQueue", producers, total, secs);
+}
+
+/// What the queues replace: a lock around a std::deque.
+void bench_locked(uint32_t producers, uint32_t items) {
+  std::mutex lock;
+  std::deque<Item> queue;
+  OrderCheck check{producers};
+
+  std::vector<std::thread> threads;
+  const auto start = Clock::now();
+  for (uint32_t p = 0; p < producers; ++p) {
+    threads.emplace_back([&, p] {
+      for (uint32_t seq = 0; seq < items; ++seq) {
+        std::lock_guard guard{lock};
+        queue.push_back(Item{p, seq});
+      }
+    });
+  }
+
+  const uint64_t total = uint64_t{producers} * items;
+  uint32_t spins = 0;
+  for (uint64_t got = 0; got < total;) {
+    Item item;
+    bool have = false;
+    {
+      std::lock_guard guard{lock};
+      if (!queue.empty()) {
+        item = queue.front();
+        queue.pop_front();
+        have = true;
+      }
+    }
+    if (have) {
+      check.saw(item);
+      ++got;
+    } else {
+      backoff(spins);
+    }
+  }
+  const double secs = seconds_since(start);
+  for (auto& t : threads) t.join();
+
+  check.finish(items);
+  report("mutex + deque", producers, total, secs);
+}
+
+void check_single_threaded() {
+  ctr::SpscRing<int, 4> ring;
+  int v = 0;
+  EXPECT(ring.empty() && !ring.try_pop(v), "new ring not empty");
+  for (int i = 0; i < 4; ++i) {
+    EXPECT(ring.try_push(i), "push %d into a ring of 4 failed", i);
+  }
+  EXPECT(ring.full() && !ring.try_push(4), "ring of 4 took a 5th item");
+  // Wrap the indices around a few times
+  for (int i = 4; i < 40; ++i) {
+    EXPECT(ring.try_pop(v) && v == i - 4, "popped %d, expected %d", v, i - 4);
+    EXPECT(ring.try_push(i), "push %d after pop failed", i);
+  }
+  EXPECT(ring.count() == 4, "count %zu, expected 4", ring.count());
+
+  ctr::MpscQueue<Node> queue;
+  Node nodes[3];
+  EXPECT(queue.empty() && !queue.pop(), "new queue not empty");
+  for (uint32_t i = 0; i < 3; ++i) {
+    nodes[i].item = Item{0, i};
+    queue.push(&nodes[i]);
+  }
+  for (uint32_t i = 0; i < 3; ++i) {
+    Node* n = queue.pop();
+    EXPECT(n == &nodes[i], "pop %u returned the wrong node", i);
+  }
+  EXPECT(queue.empty() && !queue.pop(), "drained queue not empty");
+  // Nodes may go through the queue again once popped
+  queue.push(&nodes[1]);
+  EXPECT(queue.pop() == &nodes[1] && !queue.pop(), "requeued node lost");
+}
+
+void usage(const char* argv0) {
+  std::printf("usage: %s [--items N] [--producers N] [--quick]\n", argv0);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  uint32_t items = 2'000'000;
+  uint32_t producers = 4;
+
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--items" && i + 1 < argc) {
+      items = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (arg == "--producers" && i + 1 < argc) {
+      producers = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 0));
+    } else if (arg == "--quick") {
+      items = 100'000;
+    } else {
+      usage(argv[0]);
+      return arg == "-h" || arg == "--help" ? 0 : 2;
+    }
+  }
+  if (!items || !producers) {
+    usage(argv[0]);
+    return 2;
+  }
+
+  std::printf("== single threaded\n");
+  size_t before = failures;
+  check_single_threaded();
+  std::printf("  SpscRing/MpscQueue: %s\n", failures == before ? "ok" : "FAILED");
+
+  std::printf("== %u items per producer, %u hardware threads\n", items,
+              std::thread::hardware_concurrency());
+  bench_spsc(items);
+  bench_locked(1, items);
+  bench_mpsc(1, items);
+  bench_mpsc(producers, items);
+  bench_locked(producers, items);
+
+  if (failures) {
+    std::printf("%zu check(s) failed\n", failures);
+    return 1;
+  }
+  std::printf("all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Convert a `trace dump` from the kernel's serial log into Chrome trace JSON.
+
+Everything that is not a "#trace" line (regular log output, \\r from the serial
+line, ...) is ignored, so the raw serial.log can be passed as is. If it holds
+several dumps the last one is used, even if it was cut short. Open the result in
+chrome://tracing or https://ui.perfetto.dev.
+
+Usage:
+    python3 tracedecode.py serial.log > trace.json
+    python3 tracedecode.py --clock-mhz 2400 serial.log -o trace.json
+"""
+
+import argparse
+import json
+import sys
+
+KIND_PHASE = {0: "i", 1: "B", 2: "E"}
+
+
+class Dump:
+    def __init__(self, cpus: int, clock_khz: int) -> None:
+        self.cpus = cpus
+        self.clock_khz = clock_khz
+        self.events: dict[int, tuple[str, str]] = {}
+        self.records: list[dict] = []
+
+
+def parse(lines) -> Dump | None:
+    dump = None
+    last = None
+
+    for raw in lines:
+        line = raw.strip()
+        if not line.startswith("#trace "):
+            continue
+
+        fields = line.split()
+        tag = fields[1]
+
+        if tag == "begin":
+            dump = Dump(cpus=int(fields[3], 16), clock_khz=int(fields[4], 16))
+            last = dump
+        elif dump is None:
+            continue
+        elif tag == "event":
+            kind = int(fields[3], 16)
+            dump.events[int(fields[2], 16)] = (fields[4], KIND_PHASE.get(kind, "i"))
+        elif tag == "rec" and len(fields) >= 11:
+            values = [int(f, 16) for f in fields[2:11]]
+            cpu, seq, ts, event, argc = values[:5]
+            dump.records.append(
+                {"cpu": cpu, "seq": seq, "ts": ts, "event": event, "args": values[5:5 + argc]}
+            )
+        elif tag == "end":
+            dump = None
+
+    # The newest dump wins even when it was cut short, it still decodes without its tail
+    return last
+
+
+def to_chrome(dump: Dump, clock_mhz: float) -> dict:
+    if dump.clock_khz:
+        clock_mhz = dump.clock_khz / 1000.0
+
+    records = sorted(dump.records, key=lambda r: r["ts"])
+    base = records[0]["ts"] if records else 0
+
+    out = []
+    for r in records:
+        name, phase = dump.events.get(r["event"], (f"event_{r['event']}", "i"))
+        ev = {
+            "name": name,
+            "ph": phase,
+            "ts": (r["ts"] - base) / clock_mhz,
+            "pid": 0,
+            "tid": r["cpu"],
+            "args": {f"arg{i}": hex(a) for i, a in enumerate(r["args"])},
+        }
+        if phase == "i":
+            ev["s"] = "t"
+        out.append(ev)
+
+    for cpu in range(dump.cpus):
+        out.append(
+            {"name": "thread_name", "ph": "M", "pid": 0, "tid": cpu, "args": {"name": f"cpu{cpu}"}}
+        )
+
+    return {"traceEvents": out, "displayTimeUnit": "ns"}
+
+
+def main() -> int:
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("log", nargs="?", help="serial log, stdin if omitted")
+    parser.add_argument("-o", "--output", help="output file, stdout if omitted")
+    parser.add_argument(
+        "--clock-mhz",
+        type=float,
+        default=1000.0,
+        help="cycle counter rate if the dump does not carry one (default 1000)",
+    )
+    args = parser.parse_args()
+
+    if args.log:
+        with open(args.log, encoding="ascii", errors="replace") as f:
+            dump = parse(f)
+    else:
+        dump = parse(sys.stdin)
+
+    if dump is None:
+        print("error: no '#trace begin' found", file=sys.stderr)
+        return 1
+
+    result = json.dumps(to_chrome(dump, args.clock_mhz), indent=1)
+    if args.output:
+        with open(args.output, "w", encoding="ascii") as f:
+            f.write(result)
+    else:
+        print(result)
+
+    print(f"{len(dump.records)} records decoded", file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())